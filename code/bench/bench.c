@@ -0,0 +1,573 @@
+// 명령 프로토콜 부하 생성기 / 지연 시간 벤치마크
+// N개의 동시 연결에서 설정한 명령 조합을 재생하고 처리량, 지연 시간 히스토그램,
+// 브로드캐스트가 모든 연결에 퍼지는 데 걸린 시간을 보고한다.
+//
+// 사용법: ./exec/bench [-h 호스트] [-p 포트] [-c 연결 수] [-d 초] [-P 파이프라인 깊이]
+//                      [-m led:40,segment:30,sensor:10,quiz:10,buzzer:10] [-s 시드] [-b]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "../server/protocol.h"
+
+#define BUFFER_SIZE 1024
+#define MAX_PIPELINE 64          // 연결별 최대 미응답 명령 수
+#define MAX_EVENTS 256
+#define HIST_SUB_BITS 5          // 2의 거듭제곱 구간당 32개 하위 버킷 (상대 오차 약 3%)
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS) * HIST_SUB_COUNT)
+#define FANOUT_TRACK 4096        // 동시에 추적하는 브로드캐스트 수
+
+// ===== HDR 방식 로그-선형 히스토그램 (나노초) =====
+typedef struct Histogram {
+    uint64_t counts[HIST_BUCKETS];
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    long double sum;
+} Histogram;
+
+static int hist_index(uint64_t v)
+{
+    if (v < HIST_SUB_COUNT) return (int)v;
+    int msb = 63 - __builtin_clzll(v);
+    int shift = msb - HIST_SUB_BITS;
+    return (shift + 1) * HIST_SUB_COUNT + (int)((v >> shift) - HIST_SUB_COUNT);
+}
+
+// 버킷의 대표값 (구간 중간값)
+static uint64_t hist_value(int idx)
+{
+    if (idx < HIST_SUB_COUNT) return (uint64_t)idx;
+    int shift = idx / HIST_SUB_COUNT - 1;
+    uint64_t base = (uint64_t)(idx % HIST_SUB_COUNT + HIST_SUB_COUNT) << shift;
+    return base + ((1ULL << shift) >> 1);
+}
+
+static void hist_record(Histogram *h, uint64_t v)
+{
+    h->counts[hist_index(v)]++;
+    if (h->total == 0 || v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+    h->total++;
+    h->sum += v;
+}
+
+static uint64_t hist_percentile(const Histogram *h, double p)
+{
+    if (h->total == 0) return 0;
+    uint64_t target = (uint64_t)(p / 100.0 * h->total + 0.5);
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; ++i) {
+        seen += h->counts[i];
+        if (seen >= target) {
+            uint64_t v = hist_value(i);
+            return v > h->max ? h->max : v;
+        }
+    }
+    return h->max;
+}
+
+static void print_summary(const char *name, const Histogram *h)
+{
+    if (h->total == 0) {
+        printf("  %-10s %10s\n", name, "-");
+        return;
+    }
+    printf("  %-10s %10llu  avg %8.1f  p50 %8.1f  p90 %8.1f  p99 %8.1f  p99.9 %8.1f  max %8.1f  (us)\n",
+           name, (unsigned long long)h->total,
+           (double)(h->sum / h->total) / 1000.0,
+           hist_percentile(h, 50.0) / 1000.0, hist_percentile(h, 90.0) / 1000.0,
+           hist_percentile(h, 99.0) / 1000.0, hist_percentile(h, 99.9) / 1000.0,
+           h->max / 1000.0);
+}
+
+// 2배 간격 구간으로 묶어 막대그래프 출력
+static void print_histogram(const Histogram *h)
+{
+    if (h->total == 0) return;
+    uint64_t peak = 0;
+    uint64_t groups[64] = {0};
+    for (int i = 0; i < HIST_BUCKETS; ++i) {
+        if (!h->counts[i]) continue;
+        int g = 63 - __builtin_clzll(hist_value(i) | 1);
+        groups[g] += h->counts[i];
+        if (groups[g] > peak) peak = groups[g];
+    }
+    for (int g = 0; g < 64; ++g) {
+        if (!groups[g]) continue;
+        int bar = (int)(groups[g] * 50 / peak);
+        printf("  %9.1f ~ %9.1f us | %-50.*s %llu\n",
+               (double)(1ULL << g) / 1000.0, (double)(1ULL << (g + 1)) / 1000.0,
+               bar, "##################################################",
+               (unsigned long long)groups[g]);
+    }
+}
+
+// ===== 명령 조합 =====
+typedef enum MixKind { MIX_LED, MIX_SEGMENT, MIX_SENSOR, MIX_QUIZ, MIX_BUZZER, MIX_COUNT } MixKind;
+
+static const char *mix_names[MIX_COUNT] = { "led", "segment", "sensor", "quiz", "buzzer" };
+static int mix_weights[MIX_COUNT] = { 40, 30, 10, 10, 10 };
+static int mix_total = 100;
+
+static int parse_mix(const char *spec)
+{
+    int weights[MIX_COUNT] = {0};
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", spec);
+
+    for (char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        char *colon = strchr(tok, ':');
+        int w = colon ? atoi(colon + 1) : 1;
+        if (colon) *colon = '\0';
+        int found = 0;
+        for (int k = 0; k < MIX_COUNT; ++k) {
+            if (strcmp(tok, mix_names[k]) == 0) {
+                weights[k] = w;
+                found = 1;
+            }
+        }
+        if (!found || w < 0) {
+            fprintf(stderr, "알 수 없는 명령 조합 항목: %s\n", tok);
+            return -1;
+        }
+    }
+
+    mix_total = 0;
+    for (int k = 0; k < MIX_COUNT; ++k) {
+        mix_weights[k] = weights[k];
+        mix_total += weights[k];
+    }
+    return mix_total > 0 ? 0 : -1;
+}
+
+// ===== 연결 상태 =====
+typedef struct Conn {
+    int fd;
+    int index;
+    char in[BUFFER_SIZE * 4];
+    size_t in_len;
+    uint64_t sent_at[MAX_PIPELINE];   // 미응답 명령 전송 시각 (FIFO)
+    int sent_kind[MAX_PIPELINE];
+    int head, inflight;
+    int quiz_step;                    // 1이면 다음 명령은 QUIZ_ANSWER
+    int sensor_on;                    // SENSOR_ON/OFF 번갈아 전송
+    uint64_t events_seen;             // 이 연결이 받은 브로드캐스트 수
+    unsigned int rng;
+} Conn;
+
+typedef struct FanoutSlot {
+    uint64_t seq;
+    uint64_t first;
+    uint64_t last;
+    int arrivals;
+} FanoutSlot;
+
+static Histogram hist_all;
+static Histogram hist_kind[MIX_COUNT];
+static Histogram hist_fanout;
+static FanoutSlot fanout[FANOUT_TRACK];
+static uint64_t fanout_incomplete = 0;
+static uint64_t responses = 0, sent_total = 0, events_total = 0, errors = 0;
+static int conn_count = 10;
+static int pipeline = 1;
+static int binary_mode = 0;   // 1이면 핸드셰이크 후 바이너리 프레임 사용
+
+// 명령 코드 → 텍스트 동사
+static const char *opcode_verbs[] = {
+    [PROTO_OP_LED_ON] = "LED_ON",                   [PROTO_OP_LED_OFF] = "LED_OFF",
+    [PROTO_OP_LED_BRIGHTNESS] = "LED_BRIGHTNESS",   [PROTO_OP_BUZZER_ON] = "BUZZER_ON",
+    [PROTO_OP_BUZZER_OFF] = "BUZZER_OFF",           [PROTO_OP_SEGMENT_DISPLAY] = "SEGMENT_DISPLAY",
+    [PROTO_OP_QUIZ_START] = "QUIZ_START",           [PROTO_OP_QUIZ_ANSWER] = "QUIZ_ANSWER",
+    [PROTO_OP_SENSOR_ON] = "SENSOR_ON",             [PROTO_OP_SENSOR_OFF] = "SENSOR_OFF",
+};
+
+// 전송할 명령 하나 (텍스트/바이너리 공통 표현)
+typedef struct Command {
+    uint8_t opcode;
+    int has_arg;
+    int arg;
+} Command;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// 서버가 먼저 보내는 브로드캐스트 메시지 여부
+static int is_event_line(const char *line)
+{
+    return strncmp(line, "CDS_SENSOR", 10) == 0 ||
+           strncmp(line, "SEGMENT_COUNTDOWN:", 18) == 0 ||
+           strncmp(line, "QUIZ RESULT", 11) == 0 ||
+           strncmp(line, "BUZZER_DONE", 11) == 0 ||
+           strncmp(line, "SERVER_SHUTDOWN", 15) == 0;
+}
+
+static int pick_kind(Conn *c)
+{
+    int r = rand_r(&c->rng) % mix_total;
+    for (int k = 0; k < MIX_COUNT; ++k) {
+        if (r < mix_weights[k]) return k;
+        r -= mix_weights[k];
+    }
+    return MIX_LED;
+}
+
+static int build_command(Conn *c, Command *cmd)
+{
+    cmd->has_arg = 0;
+    cmd->arg = 0;
+
+    if (c->quiz_step) {
+        c->quiz_step = 0;
+        // 정답과 오답을 섞어 오답 시 부저 경로도 측정
+        cmd->opcode = PROTO_OP_QUIZ_ANSWER;
+        cmd->has_arg = 1;
+        cmd->arg = (rand_r(&c->rng) % 2) ? 100 : 7;
+        return MIX_QUIZ;
+    }
+
+    int kind = pick_kind(c);
+    switch (kind) {
+        case MIX_LED: {
+            int r = rand_r(&c->rng) % 3;
+            if (r == 0) cmd->opcode = PROTO_OP_LED_ON;
+            else if (r == 1) cmd->opcode = PROTO_OP_LED_OFF;
+            else {
+                cmd->opcode = PROTO_OP_LED_BRIGHTNESS;
+                cmd->has_arg = 1;
+                cmd->arg = 1 + rand_r(&c->rng) % 3;
+            }
+            break;
+        }
+        case MIX_SEGMENT:
+            cmd->opcode = PROTO_OP_SEGMENT_DISPLAY;
+            cmd->has_arg = 1;
+            cmd->arg = rand_r(&c->rng) % 10;
+            break;
+        case MIX_SENSOR:
+            c->sensor_on = !c->sensor_on;
+            cmd->opcode = c->sensor_on ? PROTO_OP_SENSOR_ON : PROTO_OP_SENSOR_OFF;
+            break;
+        case MIX_QUIZ:
+            c->quiz_step = 1;
+            cmd->opcode = PROTO_OP_QUIZ_START;
+            break;
+        default:
+            cmd->opcode = (rand_r(&c->rng) % 2) ? PROTO_OP_BUZZER_ON : PROTO_OP_BUZZER_OFF;
+            break;
+    }
+    return kind;
+}
+
+static int send_next(Conn *c)
+{
+    Command cmd;
+    char buf[64];
+    size_t len;
+    int kind = build_command(c, &cmd);
+
+    int slot = (c->head + c->inflight) % MAX_PIPELINE;
+    if (binary_mode) {
+        proto_pack((uint8_t *)buf, cmd.opcode, cmd.has_arg ? PROTO_FLAG_HAS_ARG : 0, (uint16_t)slot, cmd.arg);
+        len = PROTO_FRAME_SIZE;
+    } else if (cmd.has_arg) {
+        len = snprintf(buf, sizeof(buf), "%s %d\n", opcode_verbs[cmd.opcode], cmd.arg);
+    } else {
+        len = snprintf(buf, sizeof(buf), "%s\n", opcode_verbs[cmd.opcode]);
+    }
+    c->sent_at[slot] = now_ns();
+    c->sent_kind[slot] = kind;
+
+    // 명령은 짧으므로 한 번에 전송됨 (송신 버퍼 부족 시 오류로 계산)
+    ssize_t n = send(c->fd, buf, len, MSG_NOSIGNAL);
+    if (n != (ssize_t)len) {
+        errors++;
+        return -1;
+    }
+    c->inflight++;
+    sent_total++;
+    return 0;
+}
+
+static void record_event(Conn *c, uint64_t t)
+{
+    uint64_t seq = c->events_seen++;
+    FanoutSlot *slot = &fanout[seq % FANOUT_TRACK];
+    events_total++;
+
+    if (slot->arrivals == 0 || slot->seq != seq) {
+        if (slot->arrivals > 0 && slot->arrivals < conn_count) {
+            fanout_incomplete++;  // 일부 연결이 받지 못한(병합/누락된) 브로드캐스트
+        }
+        slot->seq = seq;
+        slot->first = t;
+        slot->last = t;
+        slot->arrivals = 0;
+    }
+    if (t < slot->first) slot->first = t;
+    if (t > slot->last) slot->last = t;
+    slot->arrivals++;
+
+    if (slot->arrivals == conn_count) {
+        hist_record(&hist_fanout, slot->last - slot->first);
+        slot->arrivals = -1;  // 집계 완료 표시 (같은 seq 재진입 방지)
+    }
+}
+
+// 가장 오래된 미응답 명령의 지연 시간 기록 (응답은 요청 순서대로 도착)
+static void complete_response(Conn *c, uint64_t t)
+{
+    if (c->inflight == 0) {
+        return;  // 요청하지 않은 응답 (무시)
+    }
+
+    uint64_t latency = t - c->sent_at[c->head];
+    int kind = c->sent_kind[c->head];
+    c->head = (c->head + 1) % MAX_PIPELINE;
+    c->inflight--;
+
+    hist_record(&hist_all, latency);
+    hist_record(&hist_kind[kind], latency);
+    responses++;
+}
+
+static void handle_line(Conn *c, const char *line, uint64_t t)
+{
+    if (is_event_line(line)) {
+        record_event(c, t);
+        return;
+    }
+    complete_response(c, t);
+}
+
+static void handle_frame(Conn *c, const uint8_t *frame, uint64_t t)
+{
+    if (frame[0] == PROTO_OP_EVENT) {
+        record_event(c, t);
+        return;
+    }
+    complete_response(c, t);
+}
+
+// 수신 데이터를 줄(바이너리 모드는 8바이트 프레임) 단위로 처리, 반환값 -1은 연결 종료
+static int handle_readable(Conn *c)
+{
+    while (1) {
+        ssize_t n = recv(c->fd, c->in + c->in_len, sizeof(c->in) - c->in_len - 1, 0);
+        if (n == 0) return -1;
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            if (errno == EINTR) continue;
+            return -1;
+        }
+
+        uint64_t t = now_ns();
+        c->in_len += n;
+        c->in[c->in_len] = '\0';
+
+        char *start = c->in;
+        char *nl;
+        if (binary_mode) {
+            while (c->in + c->in_len - start >= PROTO_FRAME_SIZE) {
+                handle_frame(c, (const uint8_t *)start, t);
+                start += PROTO_FRAME_SIZE;
+            }
+        } else {
+            while ((nl = memchr(start, '\n', c->in + c->in_len - start)) != NULL) {
+                *nl = '\0';
+                handle_line(c, start, t);
+                start = nl + 1;
+            }
+        }
+        size_t rest = c->in + c->in_len - start;
+        memmove(c->in, start, rest);
+        c->in_len = rest;
+        if (c->in_len == sizeof(c->in) - 1) {
+            c->in_len = 0;  // 비정상적으로 긴 줄은 버림
+        }
+    }
+}
+
+static int connect_one(const char *host, int port)
+{
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) <= 0 ||
+        connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    // 바이너리 모드 핸드셰이크 (논블로킹 전환 전, 응답 줄을 받을 때까지 대기)
+    if (binary_mode) {
+        char ack[sizeof(PROTO_BINARY_ACK)];
+        size_t got = 0;
+        if (send(fd, PROTO_BINARY_HELLO, sizeof(PROTO_BINARY_HELLO) - 1, MSG_NOSIGNAL) < 0) {
+            close(fd);
+            return -1;
+        }
+        while (got < sizeof(ack) - 1) {
+            ssize_t n = recv(fd, ack + got, 1, 0);  // 프레임 경계를 넘지 않도록 1바이트씩
+            if (n <= 0) {
+                close(fd);
+                return -1;
+            }
+            got += n;
+            if (ack[got - 1] == '\n') break;
+        }
+        ack[got] = '\0';
+        if (strcmp(ack, PROTO_BINARY_ACK) != 0) {
+            fprintf(stderr, "바이너리 프로토콜 협상 실패: %s", ack);
+            close(fd);
+            return -1;
+        }
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "사용법: %s [-h 호스트] [-p 포트] [-c 연결 수] [-d 초] [-P 파이프라인 깊이]\n"
+            "          [-m led:40,segment:30,sensor:10,quiz:10,buzzer:10] [-s 시드] [-b]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *host = "127.0.0.1";
+    int port = 8080;
+    int duration = 10;
+    unsigned int seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "h:p:c:d:P:m:s:b")) != -1) {
+        switch (opt) {
+            case 'h': host = optarg; break;
+            case 'p': port = atoi(optarg); break;
+            case 'c': conn_count = atoi(optarg); break;
+            case 'd': duration = atoi(optarg); break;
+            case 'P': pipeline = atoi(optarg); break;
+            case 'm':
+                if (parse_mix(optarg) < 0) return 1;
+                break;
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 'b': binary_mode = 1; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (conn_count < 1 || duration < 1 || pipeline < 1 || pipeline > MAX_PIPELINE) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Conn *conns = calloc(conn_count, sizeof(Conn));
+    int epfd = epoll_create1(0);
+    if (!conns || epfd < 0) {
+        perror("초기화 실패");
+        return 1;
+    }
+
+    for (int i = 0; i < conn_count; ++i) {
+        conns[i].fd = connect_one(host, port);
+        if (conns[i].fd < 0) {
+            fprintf(stderr, "연결 실패 (%d번째): %s\n", i, strerror(errno));
+            return 1;
+        }
+        conns[i].index = i;
+        conns[i].rng = seed + i * 7919;
+
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &conns[i] };
+        epoll_ctl(epfd, EPOLL_CTL_ADD, conns[i].fd, &ev);
+    }
+
+    printf("연결 %d개, %d초, 파이프라인 깊이 %d, %s 프로토콜, 명령 조합:",
+           conn_count, duration, pipeline, binary_mode ? "바이너리" : "텍스트");
+    for (int k = 0; k < MIX_COUNT; ++k) {
+        if (mix_weights[k]) printf(" %s:%d", mix_names[k], mix_weights[k]);
+    }
+    printf("\n");
+
+    uint64_t start = now_ns();
+    uint64_t end = start + (uint64_t)duration * 1000000000ULL;
+
+    for (int i = 0; i < conn_count; ++i) {
+        while (conns[i].inflight < pipeline && send_next(&conns[i]) == 0) {
+        }
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    int alive = conn_count;
+    while (alive > 0 && now_ns() < end) {
+        int n = epoll_wait(epfd, events, MAX_EVENTS, 100);
+        if (n < 0 && errno != EINTR) break;
+
+        for (int i = 0; i < n; ++i) {
+            Conn *c = events[i].data.ptr;
+            if (handle_readable(c) < 0) {
+                epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+                close(c->fd);
+                c->fd = -1;
+                alive--;
+                errors++;
+                continue;
+            }
+            while (c->inflight < pipeline && send_next(c) == 0) {
+            }
+        }
+    }
+    double elapsed = (now_ns() - start) / 1e9;
+
+    printf("\n=== 처리량 ===\n");
+    printf("  전송 %llu, 응답 %llu, 오류 %llu, 경과 %.2f초 → %.0f 명령/초\n",
+           (unsigned long long)sent_total, (unsigned long long)responses,
+           (unsigned long long)errors, elapsed, responses / elapsed);
+
+    printf("\n=== 명령 지연 시간 ===\n");
+    print_summary("all", &hist_all);
+    for (int k = 0; k < MIX_COUNT; ++k) {
+        if (mix_weights[k]) print_summary(mix_names[k], &hist_kind[k]);
+    }
+    printf("\n=== 지연 시간 분포 ===\n");
+    print_histogram(&hist_all);
+
+    printf("\n=== 브로드캐스트 팬아웃 (첫 연결 ~ 마지막 연결 수신 간격) ===\n");
+    printf("  수신 이벤트 %llu, 모든 연결 수신 완료 %llu, 일부 연결 누락 %llu\n",
+           (unsigned long long)events_total, (unsigned long long)hist_fanout.total,
+           (unsigned long long)fanout_incomplete);
+    print_summary("fanout", &hist_fanout);
+
+    for (int i = 0; i < conn_count; ++i) {
+        if (conns[i].fd >= 0) close(conns[i].fd);
+    }
+    close(epfd);
+    free(conns);
+    return 0;
+}
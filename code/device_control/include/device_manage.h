@@ -8,6 +8,10 @@
 // 모든 장치 초기화 (한 번만 호출)
 int device_init_all(void);
 
+// 라이브러리 언로드 전 정리 (서버 RELOAD 시 이전 라이브러리에 호출): 내부 스레드 중지, 출력 끄기, fd 반환
+// 반환값: 0 = dlclose 해도 안전, -1 = 이 라이브러리 코드를 부를 수 있는 것이 남아 있어 매핑을 유지해야 함
+int device_release_all(void);
+
 // ===== LED 제어 =====
 int led_init(void);
 int led_on(void);
@@ -21,6 +25,7 @@ int buzzer_off(void);
 int buzzer_warning(void);
 int buzzer_emergency(void);
 int buzzer_success(void);
+int buzzer_tone(int freq);         // 주파수 즉시 설정 (0 = 무음), 음 길이는 호출자가 제어
 
 // ===== 7세그먼트 제어 =====
 int segment_init(void);
@@ -30,6 +35,8 @@ int segment_countdown(int start);  // start -> 0, 0이 되면 부저 자동 울
 // ===== CDS 센서 제어 =====
 int sensor_init(void);
 int sensor_get_value(int *value);
+int sensor_edge_fd(void);       // 값 변화(엣지) 시 읽기 가능해지는 eventfd
+int sensor_edge_notify(void);   // 엣지 발생 알림 (ISR/시뮬레이션 백엔드용)
 
 #endif // DEVICE_MANAGE_H
 
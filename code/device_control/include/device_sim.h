@@ -0,0 +1,42 @@
+// 시뮬레이션 장치 라이브러리(libdevice_manage_sim.so) 검사/제어용 헤더
+// device_manage.h의 모든 함수를 GPIO 없이 메모리 모델로 구현하고, 아래 API를 추가로 제공한다.
+
+#ifndef DEVICE_SIM_H
+#define DEVICE_SIM_H
+
+#include "device_manage.h"
+
+// 메모리 상의 장치 모델 스냅샷
+typedef struct DeviceSimState {
+    int led_pwm;              // 마지막 PWM 값 (ACTIVE LOW: 0 = 최대 밝기, 1023 = OFF, -1 = 미설정)
+    int buzzer_freq;          // 현재 부저 주파수 (Hz, 0 = 무음)
+    int segment_pins[4];      // 7세그먼트 핀 상태 (d, c, b, a)
+    int segment_number;       // 표시 중인 숫자 (-1 = 꺼짐)
+    int cds_value;            // 현재 CDS 센서 값 (0: 빛 감지, 1: 빛 없음)
+
+    unsigned long led_writes;      // LED PWM 쓰기 횟수
+    unsigned long buzzer_writes;   // 부저 주파수 쓰기 횟수
+    unsigned long segment_writes;  // 7세그먼트 핀 쓰기 횟수
+    unsigned long sensor_reads;    // 센서 읽기 횟수
+    unsigned long cds_edges;       // 주입된 CDS 엣지 수
+} DeviceSimState;
+
+// 현재 장치 모델 상태 복사
+int device_sim_get_state(DeviceSimState *out);
+
+// 쓰기/읽기 카운터 초기화
+void device_sim_reset_counters(void);
+
+// CDS 센서 값 설정 (값이 바뀌면 엣지 알림 발생)
+int device_sim_set_cds(int value);
+
+// CDS 신호 스크립트 실행: "값:지속ms,값:지속ms,..." 형식, 끝나면 처음부터 반복
+// NULL 또는 빈 문자열이면 실행 중인 스크립트 중지
+int device_sim_load_cds_script(const char *script);
+
+// 환경 변수 (device_init_all() 호출 시 적용)
+//   DEVICE_SIM_CDS_SCRIPT  : 시작 시 실행할 CDS 스크립트 (예: "0:500,1:500")
+//   DEVICE_SIM_FAST=1      : 부저 패턴/카운트다운의 실제 대기 생략 (부하 테스트용)
+//   DEVICE_SIM_STATE_FILE  : 상태가 바뀔 때마다 스냅샷 한 줄을 기록할 파일 경로 (외부 검사용)
+
+#endif // DEVICE_SIM_H
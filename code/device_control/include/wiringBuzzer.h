@@ -9,6 +9,8 @@ int buzzer_off(void);
 int buzzer_emergency(void);
 int buzzer_warning(void);
 int buzzer_success(void);
+int buzzer_tone(int freq);  // 주파수 즉시 설정 (0 = 무음), 블로킹 없음
+int buzzer_release(void);   // softTone 스레드 정지 (같은 핀을 새 라이브러리가 다시 쓸 수 있도록)
 
 
 #endif // WIRING_BUZZER_H
@@ -6,6 +6,14 @@
 int sensor_init(void);
 int sensor_get_value(int *value);
 
+// 엣지 알림: 센서 핀 값이 바뀔 때마다 읽기 가능해지는 eventfd 반환 (실패 시 -1)
+// fd를 읽어(8바이트) 카운터를 비운 뒤 sensor_get_value()로 현재 값을 확인한다.
+int sensor_edge_fd(void);
+int sensor_edge_notify(void);  // 엣지 발생 알림 (ISR/시뮬레이션 백엔드용)
+
+// 언로드 전 정리: 인터럽트가 등록되어 있으면 wiringPi가 이 라이브러리의 콜백을 계속 부르므로 -1
+int sensor_release(void);
+
 #endif // WIRING_CDS_H
 
 
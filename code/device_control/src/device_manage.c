@@ -27,6 +27,14 @@ int device_init_all(void) {
     return 0;
 }
 
+// ===== 언로드 전 정리 =====
+// softTone 스레드와 핀은 wiringPi 쪽 자원이라 정지만 하면 되지만,
+// CDS 인터럽트는 해제 API가 없어 한 번 등록했으면 이 라이브러리를 언로드할 수 없음
+int device_release_all(void) {
+    buzzer_release();
+    return sensor_release();
+}
+
 // ===== LED 제어 (기존 함수 재사용) =====
 // wiringLED.c의 함수들을 그대로 사용
 
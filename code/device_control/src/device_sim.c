@@ -0,0 +1,449 @@
+// 시뮬레이션 장치 제어 라이브러리 (libdevice_manage_sim.so)
+// wiringPi/softTone 없이 device_manage.h의 모든 함수를 메모리 모델로 구현한다.
+// x86 CI/스테이징에서 실제 서버를 GPIO 없이 부하 테스트하기 위한 용도.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+#include "../include/device_sim.h"
+
+// 실제 하드웨어(wiringLED.c / wiring7Seg.c / wiringBuzzer.c)와 같은 값 사용
+#define LED_PWM_OFF 1023
+#define SIM_SCRIPT_MAX 64   // CDS 스크립트 최대 단계 수
+
+// 0~9에 대한 세그먼트 패턴 (d,c,b,a)
+static const int segment_numbers[10][4] = {
+    {0,0,0,0}, {0,0,0,1}, {0,0,1,0}, {0,0,1,1}, {0,1,0,0},
+    {0,1,0,1}, {0,1,1,0}, {0,1,1,1}, {1,0,0,0}, {1,0,0,1}
+};
+
+static pthread_mutex_t sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DeviceSimState sim_state = {
+    .led_pwm = -1,
+    .segment_number = -1,
+};
+
+static int sim_initialized = 0;
+static int sim_fast = 0;           // DEVICE_SIM_FAST=1: 대기 생략
+static int sim_state_fd = -1;      // DEVICE_SIM_STATE_FILE
+static int sensor_edge_efd = -1;
+
+// CDS 스크립트 실행 상태
+typedef struct CdsStep {
+    int value;
+    int duration_ms;
+} CdsStep;
+
+static CdsStep cds_script[SIM_SCRIPT_MAX];
+static int cds_script_len = 0;
+static int cds_script_generation = 0;   // 스크립트 교체 시 이전 스레드 종료용
+static pthread_cond_t cds_script_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t cds_script_tid;        // 실행 중인 스크립트 스레드 (교체/정리 시 join)
+static int cds_script_thread_running = 0;
+
+// 상태 파일에 현재 스냅샷 기록 (sim_mutex 잠금 전제)
+static void dump_state_locked(void)
+{
+    if (sim_state_fd < 0) return;
+
+    char line[256];
+    int len = snprintf(line, sizeof(line),
+                       "led_pwm=%d buzzer_freq=%d segment=%d pins=%d%d%d%d cds=%d "
+                       "led_writes=%lu buzzer_writes=%lu segment_writes=%lu sensor_reads=%lu cds_edges=%lu\n",
+                       sim_state.led_pwm, sim_state.buzzer_freq, sim_state.segment_number,
+                       sim_state.segment_pins[0], sim_state.segment_pins[1],
+                       sim_state.segment_pins[2], sim_state.segment_pins[3],
+                       sim_state.cds_value,
+                       sim_state.led_writes, sim_state.buzzer_writes, sim_state.segment_writes,
+                       sim_state.sensor_reads, sim_state.cds_edges);
+    if (len > 0 && pwrite(sim_state_fd, line, len, 0) == len) {
+        if (ftruncate(sim_state_fd, len) < 0) {
+            // 검사용 파일이므로 실패는 무시
+        }
+    }
+}
+
+// 실제 하드웨어 타이밍 재현 (DEVICE_SIM_FAST=1이면 생략)
+static void sim_delay_us(useconds_t us)
+{
+    if (!sim_fast) {
+        usleep(us);
+    }
+}
+
+static void sim_pwm_write(int value)
+{
+    pthread_mutex_lock(&sim_mutex);
+    sim_state.led_pwm = value;
+    sim_state.led_writes++;
+    dump_state_locked();
+    pthread_mutex_unlock(&sim_mutex);
+}
+
+static void sim_tone_write(int freq)
+{
+    pthread_mutex_lock(&sim_mutex);
+    sim_state.buzzer_freq = freq;
+    sim_state.buzzer_writes++;
+    dump_state_locked();
+    pthread_mutex_unlock(&sim_mutex);
+}
+
+static void sim_segment_write(const int pins[4], int number)
+{
+    pthread_mutex_lock(&sim_mutex);
+    memcpy(sim_state.segment_pins, pins, sizeof(sim_state.segment_pins));
+    sim_state.segment_number = number;
+    sim_state.segment_writes += 4;
+    dump_state_locked();
+    pthread_mutex_unlock(&sim_mutex);
+}
+
+// ===== CDS 스크립트 스레드 =====
+
+// arg: 이 스레드가 실행할 스크립트 세대 번호 (교체되면 종료)
+static void *cds_script_thread_func(void *arg)
+{
+    int generation = (int)(intptr_t)arg;
+    int step = 0;
+
+    pthread_mutex_lock(&sim_mutex);
+    while (generation == cds_script_generation && cds_script_len > 0) {
+        CdsStep current = cds_script[step];
+        pthread_mutex_unlock(&sim_mutex);
+
+        device_sim_set_cds(current.value);
+
+        // 지속 시간 동안 대기 (스크립트 교체 시 즉시 깨어남)
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += current.duration_ms / 1000;
+        deadline.tv_nsec += (long)(current.duration_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        pthread_mutex_lock(&sim_mutex);
+        while (generation == cds_script_generation &&
+               pthread_cond_timedwait(&cds_script_cond, &sim_mutex, &deadline) == 0) {
+            // 조건 변수 신호: 스크립트 교체 여부를 다시 확인
+        }
+        if (cds_script_len > 0) {
+            step = (step + 1) % cds_script_len;
+        }
+    }
+    pthread_mutex_unlock(&sim_mutex);
+    return NULL;
+}
+
+int device_sim_load_cds_script(const char *script)
+{
+    CdsStep steps[SIM_SCRIPT_MAX];
+    int count = 0;
+
+    if (script) {
+        const char *p = script;
+        while (*p && count < SIM_SCRIPT_MAX) {
+            int value, duration, consumed = 0;
+            if (sscanf(p, " %d : %d %n", &value, &duration, &consumed) < 2 || duration <= 0) {
+                fprintf(stderr, "CDS 스크립트 형식 오류: %s\n", p);
+                return -1;
+            }
+            steps[count].value = value ? 1 : 0;
+            steps[count].duration_ms = duration;
+            count++;
+            p += consumed;
+            if (*p == ',') p++;
+        }
+    }
+
+    // 이전 스크립트 스레드를 깨워 끝날 때까지 기다림 (언로드 전에 이 라이브러리 코드를 벗어나야 하므로 join)
+    pthread_mutex_lock(&sim_mutex);
+    cds_script_len = 0;
+    cds_script_generation++;
+    pthread_cond_broadcast(&cds_script_cond);
+    int had_thread = cds_script_thread_running;
+    pthread_t old_tid = cds_script_tid;
+    cds_script_thread_running = 0;
+    pthread_mutex_unlock(&sim_mutex);
+    if (had_thread) {
+        pthread_join(old_tid, NULL);
+    }
+
+    pthread_mutex_lock(&sim_mutex);
+    memcpy(cds_script, steps, sizeof(CdsStep) * count);
+    cds_script_len = count;
+
+    int rc = 0;
+    if (count > 0) {
+        if (pthread_create(&cds_script_tid, NULL, cds_script_thread_func,
+                           (void *)(intptr_t)cds_script_generation) == 0) {
+            cds_script_thread_running = 1;
+        } else {
+            rc = -1;
+        }
+    }
+    pthread_mutex_unlock(&sim_mutex);
+    return rc;
+}
+
+// ===== 검사/제어 API =====
+
+int device_sim_get_state(DeviceSimState *out)
+{
+    if (!out) return -1;
+    pthread_mutex_lock(&sim_mutex);
+    *out = sim_state;
+    pthread_mutex_unlock(&sim_mutex);
+    return 0;
+}
+
+void device_sim_reset_counters(void)
+{
+    pthread_mutex_lock(&sim_mutex);
+    sim_state.led_writes = 0;
+    sim_state.buzzer_writes = 0;
+    sim_state.segment_writes = 0;
+    sim_state.sensor_reads = 0;
+    sim_state.cds_edges = 0;
+    dump_state_locked();
+    pthread_mutex_unlock(&sim_mutex);
+}
+
+int device_sim_set_cds(int value)
+{
+    value = value ? 1 : 0;
+
+    pthread_mutex_lock(&sim_mutex);
+    int changed = (sim_state.cds_value != value);
+    sim_state.cds_value = value;
+    if (changed) {
+        sim_state.cds_edges++;
+        dump_state_locked();
+    }
+    pthread_mutex_unlock(&sim_mutex);
+
+    if (changed) {
+        sensor_edge_notify();
+    }
+    return 0;
+}
+
+// ===== 전체 장치 초기화 =====
+int device_init_all(void)
+{
+    pthread_mutex_lock(&sim_mutex);
+    if (sim_initialized) {
+        pthread_mutex_unlock(&sim_mutex);
+        return 0;
+    }
+    sim_initialized = 1;
+
+    const char *fast = getenv("DEVICE_SIM_FAST");
+    sim_fast = (fast && strcmp(fast, "1") == 0);
+
+    const char *state_file = getenv("DEVICE_SIM_STATE_FILE");
+    if (state_file && *state_file) {
+        sim_state_fd = open(state_file, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        dump_state_locked();
+    }
+    pthread_mutex_unlock(&sim_mutex);
+
+    const char *script = getenv("DEVICE_SIM_CDS_SCRIPT");
+    if (script && *script) {
+        return device_sim_load_cds_script(script);
+    }
+    return 0;
+}
+
+// ===== 언로드 전 정리 =====
+// 스크립트 스레드를 join하고 fd를 닫으면 이 라이브러리 코드를 부르는 것이 남지 않음
+int device_release_all(void)
+{
+    device_sim_load_cds_script(NULL);
+
+    pthread_mutex_lock(&sim_mutex);
+    if (sensor_edge_efd >= 0) {
+        close(sensor_edge_efd);
+        sensor_edge_efd = -1;
+    }
+    if (sim_state_fd >= 0) {
+        close(sim_state_fd);
+        sim_state_fd = -1;
+    }
+    sim_initialized = 0;
+    pthread_mutex_unlock(&sim_mutex);
+    return 0;
+}
+
+// ===== LED =====
+int led_init(void)
+{
+    return 0;
+}
+
+int led_on(void)
+{
+    sim_pwm_write(0);
+    return 0;
+}
+
+int led_off(void)
+{
+    sim_pwm_write(LED_PWM_OFF);
+    return 0;
+}
+
+int led_set_brightness(int level)
+{
+    int value = 0;
+    switch (level) {
+        case 1: value = 768; break;
+        case 2: value = 512; break;
+        case 3: value = 0;   break;
+        default:
+            fprintf(stderr, "잘못된 밝기 레벨: %d\n", level);
+            return -1;
+    }
+    sim_pwm_write(value);
+    return 0;
+}
+
+// ===== 부저 (wiringBuzzer.c와 같은 음/길이) =====
+int buzzer_init(void)
+{
+    return 0;
+}
+
+static int sim_play(const int *notes, const int *durations, int count)
+{
+    for (int i = 0; i < count; i++) {
+        sim_tone_write(notes[i]);
+        sim_delay_us(durations[i]);
+    }
+    sim_tone_write(0);
+    return 0;
+}
+
+int buzzer_warning(void)
+{
+    static const int notes[] = {440};
+    static const int durations[] = {200000};
+    return sim_play(notes, durations, 1);
+}
+
+int buzzer_emergency(void)
+{
+    static const int notes[] = {880};
+    static const int durations[] = {200000};
+    return sim_play(notes, durations, 1);
+}
+
+int buzzer_success(void)
+{
+    static const int notes[] = {262, 330, 392, 523};
+    static const int durations[] = {150000, 150000, 150000, 300000};
+    return sim_play(notes, durations, 4);
+}
+
+int buzzer_fail(void)
+{
+    static const int notes[] = {330, 262, 196};
+    static const int durations[] = {200000, 200000, 400000};
+    return sim_play(notes, durations, 3);
+}
+
+int buzzer_on(void)
+{
+    sim_tone_write(440);
+    return 0;
+}
+
+int buzzer_off(void)
+{
+    sim_tone_write(0);
+    return 0;
+}
+
+int buzzer_tone(int freq)
+{
+    sim_tone_write(freq < 0 ? 0 : freq);
+    return 0;
+}
+
+// ===== 7세그먼트 =====
+int segment_init(void)
+{
+    return 0;
+}
+
+int segment_display(int number)
+{
+    if (number < 0 || number > 9) {
+        fprintf(stderr, "세그먼트 표시 범위 초과: %d\n", number);
+        return -1;
+    }
+    sim_segment_write(segment_numbers[number], number);
+    return 0;
+}
+
+int segment_countdown(int start)
+{
+    static const int cleared[4] = {0, 0, 0, 0};
+
+    if (start < 0) start = 0;
+    if (start > 9) start = 9;
+
+    for (int n = start; n > 0; --n) {
+        segment_display(n);
+        sim_delay_us(1000000);
+    }
+    segment_display(0);
+    buzzer_on();
+    sim_delay_us(500000);
+    buzzer_off();
+    sim_segment_write(cleared, -1);
+    return 0;
+}
+
+// ===== CDS 센서 =====
+int sensor_init(void)
+{
+    return 0;
+}
+
+int sensor_get_value(int *value)
+{
+    if (value == NULL) return -1;
+    pthread_mutex_lock(&sim_mutex);
+    *value = sim_state.cds_value;
+    sim_state.sensor_reads++;
+    pthread_mutex_unlock(&sim_mutex);
+    return 0;
+}
+
+int sensor_edge_notify(void)
+{
+    uint64_t one = 1;
+    if (sensor_edge_efd < 0) return -1;
+    if (write(sensor_edge_efd, &one, sizeof(one)) < 0) return -1;
+    return 0;
+}
+
+int sensor_edge_fd(void)
+{
+    pthread_mutex_lock(&sim_mutex);
+    if (sensor_edge_efd < 0) {
+        sensor_edge_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+    int fd = sensor_edge_efd;
+    pthread_mutex_unlock(&sim_mutex);
+    return fd;
+}
@@ -92,4 +92,21 @@ int buzzer_off(void) {
     if (buzzer_init() < 0) return -1;
     softToneWrite(BUZZER_PIN, 0);
     return 0;
-}
\ No newline at end of file
+}
+
+// 지정 주파수로 즉시 전환 (0 = 무음, 대기 없음: 시간 제어는 호출자가 담당)
+int buzzer_tone(int freq) {
+    if (buzzer_init() < 0) return -1;
+    if (freq < 0) freq = 0;
+    softToneWrite(BUZZER_PIN, freq);
+    return 0;
+}
+// softTone 스레드 정지 (다음 buzzer_init에서 다시 생성)
+int buzzer_release(void) {
+    if (buzzer_initialized) {
+        softToneWrite(BUZZER_PIN, 0);
+        softToneStop(BUZZER_PIN);
+        buzzer_initialized = 0;
+    }
+    return 0;
+}
@@ -1,4 +1,8 @@
 #include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
 #include <wiringPi.h>
 
 #include "../include/wiringCDS.h"
@@ -8,6 +12,10 @@
 
 static int sensor_initialized = 0;
 
+// 엣지 알림용 eventfd (sensor_edge_fd() 최초 호출 시 생성)
+static int sensor_edge_efd = -1;
+static pthread_mutex_t sensor_edge_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 int sensor_init(void)
 {
     if (!sensor_initialized) {
@@ -28,4 +36,53 @@ int sensor_get_value(int *value)
     return 0;
 }
 
+// 엣지 발생 알림: eventfd 카운터 증가 (ISR 및 시뮬레이션 백엔드에서 호출)
+int sensor_edge_notify(void)
+{
+    uint64_t one = 1;
+    if (sensor_edge_efd < 0) return -1;
+    if (write(sensor_edge_efd, &one, sizeof(one)) < 0) return -1;
+    return 0;
+}
+
+// wiringPi 인터럽트 콜백 (wiringPi 내부 스레드에서 호출)
+static void sensor_isr(void)
+{
+    sensor_edge_notify();
+}
 
+int sensor_edge_fd(void)
+{
+    pthread_mutex_lock(&sensor_edge_mutex);
+    if (sensor_edge_efd < 0) {
+        if (sensor_init() < 0) {
+            pthread_mutex_unlock(&sensor_edge_mutex);
+            return -1;
+        }
+        int efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (efd < 0) {
+            pthread_mutex_unlock(&sensor_edge_mutex);
+            return -1;
+        }
+        sensor_edge_efd = efd;
+        // 상승/하강 엣지 모두에서 인터럽트 (핀당 1회만 등록 가능하므로 fd와 함께 한 번만)
+        if (wiringPiISR(SENSOR_PIN, INT_EDGE_BOTH, sensor_isr) < 0) {
+            fprintf(stderr, "CDS 센서 인터럽트 등록 실패\n");
+            close(efd);
+            sensor_edge_efd = -1;
+            pthread_mutex_unlock(&sensor_edge_mutex);
+            return -1;
+        }
+    }
+    pthread_mutex_unlock(&sensor_edge_mutex);
+    return sensor_edge_efd;
+}
+
+int sensor_release(void)
+{
+    pthread_mutex_lock(&sensor_edge_mutex);
+    int registered = sensor_edge_efd >= 0;
+    pthread_mutex_unlock(&sensor_edge_mutex);
+    // fd도 ISR이 계속 쓰므로 닫지 않음
+    return registered ? -1 : 0;
+}
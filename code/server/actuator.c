@@ -0,0 +1,482 @@
+// 부저 액추에이터(톤 시퀀서) 작업 스레드
+// - 패턴은 (주파수, 길이) 단계 표로 정의: 기본 내장 표 + 시작 시 설정 파일 + 클라이언트 일회성 시퀀스
+// - 단계 마감 시각은 CLOCK_MONOTONIC 절대 시각으로 누적하여 오차가 쌓이지 않음
+// - 마감 직전까지는 조건 변수로 대기하여 선점 요청에 즉시 깨어나고,
+//   마지막 ACTUATOR_FINE_WAIT_MS 구간만 clock_nanosleep(TIMER_ABSTIME)으로 정밀 대기
+// - 음마다 예정 시각 대비 실제 주파수 설정 시각의 차이(지터)를 통계로 누적
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <signal.h>
+
+#include "actuator.h"
+#include "logger.h"
+
+#define ACTUATOR_QUEUE_LEN   8    // 대기 중인 패턴 최대 수
+#define ACTUATOR_FINE_WAIT_MS 2   // 마감 직전 정밀 대기 구간 (이 구간에서는 선점이 최대 이만큼 늦어짐)
+#define ACTUATOR_MAX_FREQ    20000
+#define ACTUATOR_MAX_STEP_MS 10000
+#define HOLD_PATTERN 0            // actuator_hold 작업 (패턴 표에 없음, 다음 작업이 올 때까지 유지)
+
+typedef enum ActuatorPolicy {
+    ACTUATOR_MERGE,    // 같은 패턴이 재생/대기 중이면 그 작업에 합치고, 아니면 뒤에 대기
+    ACTUATOR_PREEMPT   // 재생 중인 패턴을 중단하고 대기 중인 패턴도 취소한 뒤 즉시 재생
+} ActuatorPolicy;
+
+typedef struct PatternDef {
+    char name[24];
+    ActuatorPolicy policy;
+    int count;
+    ToneStep steps[ACTUATOR_MAX_STEPS];
+} PatternDef;
+
+// 패턴 표: 0번은 비워 두고 1번부터 사용 (시작 후에는 읽기 전용)
+static PatternDef patterns[ACTUATOR_MAX_PATTERNS];
+static int pattern_count = 0;   // 사용 중인 마지막 번호 + 1
+
+typedef struct ActuatorJob {
+    unsigned int id;
+    int pattern;      // 패턴 번호, HOLD_PATTERN 또는 BUZZER_PATTERN_CUSTOM
+    int hold_freq;    // HOLD_PATTERN의 주파수
+    int notify;       // 종료 시 done 콜백 호출 여부
+    int count;        // BUZZER_PATTERN_CUSTOM의 음 수
+    ToneStep steps[ACTUATOR_MAX_STEPS];
+} ActuatorJob;
+
+static pthread_mutex_t act_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t act_cond;
+static pthread_t act_thread;
+static int act_started = 0;
+static int act_stopping = 0;
+
+static ActuatorJob act_queue[ACTUATOR_QUEUE_LEN];
+static int act_head = 0;
+static int act_count = 0;
+
+static ActuatorJob act_current;
+static int act_playing = 0;   // act_current가 재생 중
+static int act_preempt = 0;   // act_current 중단 요청
+static unsigned int act_next_id = 1;
+
+static ActuatorStats act_stats;
+static long long act_jitter_sum_us = 0;
+
+static actuator_tone_fn act_tone = NULL;
+static actuator_done_fn act_done = NULL;
+
+// 기본 내장 패턴 (음/길이는 wiringBuzzer.c의 블로킹 패턴 함수와 동일)
+static void define_pattern(int index, const char *name, ActuatorPolicy policy, const ToneStep *steps, int count) {
+    PatternDef *def = &patterns[index];
+    snprintf(def->name, sizeof(def->name), "%s", name);
+    def->policy = policy;
+    def->count = count;
+    memcpy(def->steps, steps, sizeof(ToneStep) * count);
+    if (index >= pattern_count) pattern_count = index + 1;
+}
+
+static void init_builtin_patterns(void) {
+    static const ToneStep warning_steps[]   = { {440, 200} };
+    static const ToneStep emergency_steps[] = { {880, 200} };
+    static const ToneStep success_steps[]   = { {262, 150}, {330, 150}, {392, 150}, {523, 300} };
+    static const ToneStep fail_steps[]      = { {330, 200}, {262, 200}, {196, 400} };
+    static const ToneStep alarm_steps[]     = { {440, 500} };
+
+    if (pattern_count > 0) return;
+    define_pattern(BUZZER_PATTERN_WARNING,   "warning",   ACTUATOR_MERGE,   warning_steps, 1);
+    define_pattern(BUZZER_PATTERN_EMERGENCY, "emergency", ACTUATOR_PREEMPT, emergency_steps, 1);
+    define_pattern(BUZZER_PATTERN_SUCCESS,   "success",   ACTUATOR_PREEMPT, success_steps, 4);
+    define_pattern(BUZZER_PATTERN_FAIL,      "fail",      ACTUATOR_PREEMPT, fail_steps, 3);
+    define_pattern(BUZZER_PATTERN_ALARM,     "alarm",     ACTUATOR_MERGE,   alarm_steps, 1);
+}
+
+int actuator_parse_steps(const char *text, ToneStep *out, int max) {
+    int count = 0;
+    const char *p = text;
+
+    while (*p) {
+        char *end;
+        while (*p == ' ' || *p == '\t') p++;
+        long freq = strtol(p, &end, 10);
+        if (end == p || *end != ':') return -1;
+        p = end + 1;
+        long ms = strtol(p, &end, 10);
+        if (end == p) return -1;
+        p = end;
+        while (*p == ' ' || *p == '\t') p++;
+
+        if (count == max || freq < 0 || freq > ACTUATOR_MAX_FREQ || ms <= 0 || ms > ACTUATOR_MAX_STEP_MS) {
+            return -1;
+        }
+        out[count].freq = (int)freq;
+        out[count].duration_ms = (int)ms;
+        count++;
+
+        if (*p == ',') {
+            p++;
+        } else if (*p != '\0' && *p != '\r' && *p != '\n') {
+            return -1;
+        } else {
+            break;
+        }
+    }
+    return count > 0 ? count : -1;
+}
+
+int actuator_find_pattern(const char *name) {
+    init_builtin_patterns();
+    for (int i = 1; i < pattern_count; ++i) {
+        if (patterns[i].count > 0 && strcmp(patterns[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+int actuator_load_patterns(const char *path) {
+    char line[512];
+    char log_msg[2200];  // 데몬 실행 중에는 stderr가 /dev/null이므로 오류 줄은 로그 파일에 기록
+    int loaded = 0;
+    int line_no = 0;
+
+    init_builtin_patterns();
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+
+    while (fgets(line, sizeof(line), fp)) {
+        char name[64], policy[16], steps_text[448];
+        ToneStep steps[ACTUATOR_MAX_STEPS];
+        line_no++;
+
+        char *p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '#' || *p == '\0') continue;
+
+        if (sscanf(p, "%63s %15s %447[^\n]", name, policy, steps_text) != 3 ||
+            strlen(name) >= sizeof(patterns[0].name) ||
+            (strcmp(policy, "merge") != 0 && strcmp(policy, "preempt") != 0)) {
+            snprintf(log_msg, sizeof(log_msg), "%s:%d: 패턴 형식 오류", path, line_no);
+            log_event_level(LOG_LEVEL_WARN, log_msg);
+            continue;
+        }
+        int count = actuator_parse_steps(steps_text, steps, ACTUATOR_MAX_STEPS);
+        if (count < 0) {
+            snprintf(log_msg, sizeof(log_msg), "%s:%d: 음 목록 형식 오류", path, line_no);
+            log_event_level(LOG_LEVEL_WARN, log_msg);
+            continue;
+        }
+
+        // 같은 이름은 덮어쓰고, 새 이름은 다음 번호에 추가
+        int index = actuator_find_pattern(name);
+        if (index == 0) {
+            if (pattern_count >= ACTUATOR_MAX_PATTERNS) {
+                snprintf(log_msg, sizeof(log_msg), "%s:%d: 패턴 수 초과 (최대 %d)", path, line_no,
+                         ACTUATOR_MAX_PATTERNS - 1);
+                log_event_level(LOG_LEVEL_WARN, log_msg);
+                continue;
+            }
+            index = pattern_count;
+        }
+        define_pattern(index, name, strcmp(policy, "merge") == 0 ? ACTUATOR_MERGE : ACTUATOR_PREEMPT,
+                       steps, count);
+        loaded++;
+    }
+    fclose(fp);
+    return loaded;
+}
+
+const char *actuator_pattern_name(int pattern) {
+    if (pattern == BUZZER_PATTERN_CUSTOM) return "custom";
+    if (pattern <= 0 || pattern >= pattern_count || patterns[pattern].count == 0) return NULL;
+    return patterns[pattern].name;
+}
+
+static void notify_done(const ActuatorJob *job, ActuatorResult result) {
+    if (job->notify && act_done) {
+        act_done(job->id, job->pattern, result);
+    }
+}
+
+static void timespec_add_ms(struct timespec *ts, long ms) {
+    long long ns = (long long)ts->tv_nsec + ms * 1000000LL;
+    ts->tv_sec += (time_t)(ns / 1000000000LL);
+    ns %= 1000000000LL;
+    if (ns < 0) {
+        ns += 1000000000LL;
+        ts->tv_sec--;
+    }
+    ts->tv_nsec = (long)ns;
+}
+
+// 예정 시각 대비 늦은 정도 기록 (act_lock 잠금 전제)
+static void record_jitter_locked(const struct timespec *scheduled, const struct timespec *actual) {
+    long jitter_us = (long)((actual->tv_sec - scheduled->tv_sec) * 1000000L +
+                            (actual->tv_nsec - scheduled->tv_nsec) / 1000L);
+    if (jitter_us < 0) jitter_us = -jitter_us;
+
+    act_stats.steps++;
+    act_stats.last_jitter_us = jitter_us;
+    if (jitter_us > act_stats.max_jitter_us) act_stats.max_jitter_us = jitter_us;
+    if (jitter_us > 1000) act_stats.late_over_1ms++;
+    act_jitter_sum_us += jitter_us;
+}
+
+// 절대 시각 deadline까지 대기 (act_lock 잠금 전제), 선점/종료 요청으로 깨어나면 1
+static int wait_until_locked(const struct timespec *deadline) {
+    struct timespec coarse = *deadline;
+    timespec_add_ms(&coarse, -ACTUATOR_FINE_WAIT_MS);
+
+    while (!act_stopping && !act_preempt) {
+        if (pthread_cond_timedwait(&act_cond, &act_lock, &coarse) == ETIMEDOUT) {
+            break;
+        }
+    }
+    if (act_stopping || act_preempt) {
+        return 1;
+    }
+
+    pthread_mutex_unlock(&act_lock);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL) == EINTR) {
+        // 시그널로 깨어나도 같은 절대 시각으로 다시 대기
+    }
+    pthread_mutex_lock(&act_lock);
+    return 0;
+}
+
+// 작업 스레드: 큐에서 패턴을 꺼내 단계별로 주파수를 바꾸고 마감 시각까지 대기
+static void *actuator_thread_func(void *arg) {
+    (void)arg;
+    struct timespec deadline, now;
+    ToneStep hold_step;
+    int step = 0;
+
+    pthread_mutex_lock(&act_lock);
+    while (!act_stopping) {
+        if (!act_playing) {
+            if (act_count == 0) {
+                pthread_cond_wait(&act_cond, &act_lock);
+                continue;
+            }
+            act_current = act_queue[act_head];
+            act_head = (act_head + 1) % ACTUATOR_QUEUE_LEN;
+            act_count--;
+            act_playing = 1;
+            act_preempt = 0;
+            step = 0;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+        }
+
+        // 선점됨: 무음으로 돌리지 않고 바로 다음 작업의 첫 음으로 전환
+        if (act_preempt) {
+            ActuatorJob job = act_current;
+            act_playing = 0;
+            act_preempt = 0;
+            if (job.pattern != HOLD_PATTERN) act_stats.preempted++;
+            pthread_mutex_unlock(&act_lock);
+            notify_done(&job, ACTUATOR_PREEMPTED);
+            pthread_mutex_lock(&act_lock);
+            continue;
+        }
+
+        const ToneStep *steps;
+        int count;
+        if (act_current.pattern == HOLD_PATTERN) {
+            hold_step.freq = act_current.hold_freq;
+            hold_step.duration_ms = -1;
+            steps = &hold_step;
+            count = 1;
+        } else if (act_current.pattern == BUZZER_PATTERN_CUSTOM) {
+            steps = act_current.steps;
+            count = act_current.count;
+        } else {
+            steps = patterns[act_current.pattern].steps;
+            count = patterns[act_current.pattern].count;
+        }
+
+        int first = (step == 0);
+        int freq = (step == count) ? 0 : steps[step].freq;
+        pthread_mutex_unlock(&act_lock);
+        act_tone(freq);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        pthread_mutex_lock(&act_lock);
+        if (!first) {
+            record_jitter_locked(&deadline, &now);  // 첫 음은 요청 즉시 시작하므로 제외
+        }
+
+        if (step == count) {
+            ActuatorJob job = act_current;
+            act_playing = 0;
+            pthread_mutex_unlock(&act_lock);
+            notify_done(&job, ACTUATOR_COMPLETE);
+            pthread_mutex_lock(&act_lock);
+            continue;
+        }
+
+        int duration_ms = steps[step++].duration_ms;
+        if (duration_ms < 0) {
+            // 유지음(actuator_hold)은 선점 요청뿐 아니라 뒤에 들어온 병합 정책 작업에도 양보
+            while (!act_stopping && !act_preempt && act_count == 0) {
+                pthread_cond_wait(&act_cond, &act_lock);
+            }
+            if (!act_stopping && !act_preempt) {
+                ActuatorJob job = act_current;  // 무음 없이 다음 작업의 첫 음으로 전환
+                act_playing = 0;
+                pthread_mutex_unlock(&act_lock);
+                notify_done(&job, ACTUATOR_COMPLETE);
+                pthread_mutex_lock(&act_lock);
+            }
+            continue;
+        }
+
+        timespec_add_ms(&deadline, duration_ms);
+        wait_until_locked(&deadline);
+    }
+    pthread_mutex_unlock(&act_lock);
+
+    act_tone(0);
+    return NULL;
+}
+
+int actuator_start(actuator_tone_fn tone, actuator_done_fn done) {
+    if (act_started) return 0;
+    if (!tone) return -1;
+
+    init_builtin_patterns();
+    act_tone = tone;
+    act_done = done;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&act_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    // 작업 스레드는 시그널을 받지 않도록 모든 시그널을 막은 채 생성
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    act_stopping = 0;
+    int rc = pthread_create(&act_thread, NULL, actuator_thread_func, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc != 0) {
+        pthread_cond_destroy(&act_cond);
+        return -1;
+    }
+    act_started = 1;
+    return 0;
+}
+
+// 재생 중인 패턴을 끝까지 기다리지 않고 중지 (부저는 무음으로 남김)
+void actuator_stop(void) {
+    if (!act_started) return;
+
+    pthread_mutex_lock(&act_lock);
+    act_stopping = 1;
+    pthread_cond_signal(&act_cond);
+    pthread_mutex_unlock(&act_lock);
+
+    pthread_join(act_thread, NULL);
+    pthread_cond_destroy(&act_cond);
+    act_started = 0;
+}
+
+// 선점: 대기 중인 작업을 모두 꺼내 dropped에 담고 재생 중인 작업에 중단 요청 (act_lock 잠금 전제)
+static int preempt_locked(ActuatorJob *dropped) {
+    int n = 0;
+    while (act_count > 0) {
+        dropped[n] = act_queue[act_head];
+        if (dropped[n].pattern != HOLD_PATTERN) act_stats.preempted++;
+        act_head = (act_head + 1) % ACTUATOR_QUEUE_LEN;
+        act_count--;
+        n++;
+    }
+    if (act_playing) {
+        act_preempt = 1;
+    }
+    return n;
+}
+
+// 새 작업을 큐 끝에 추가하고 번호 부여 (act_lock 잠금 전제, 빈 자리 확인 후 호출)
+static unsigned int push_locked(ActuatorJob *job) {
+    job->id = act_next_id++;
+    if (act_next_id == 0) act_next_id = 1;  // 0은 실패 표시용
+
+    act_queue[(act_head + act_count) % ACTUATOR_QUEUE_LEN] = *job;
+    act_count++;
+    pthread_cond_signal(&act_cond);
+    return job->id;
+}
+
+// 선점 정책으로 작업 추가 후 취소된 대기 작업은 잠금 밖에서 알림
+static unsigned int submit_preempt(ActuatorJob *job) {
+    ActuatorJob dropped[ACTUATOR_QUEUE_LEN];
+
+    pthread_mutex_lock(&act_lock);
+    int dropped_count = preempt_locked(dropped);
+    unsigned int id = push_locked(job);
+    pthread_mutex_unlock(&act_lock);
+
+    for (int i = 0; i < dropped_count; ++i) {
+        notify_done(&dropped[i], ACTUATOR_PREEMPTED);
+    }
+    return id;
+}
+
+unsigned int actuator_play(int pattern, int notify) {
+    if (!act_started || !actuator_pattern_name(pattern) || pattern == BUZZER_PATTERN_CUSTOM) return 0;
+
+    ActuatorJob job = { .pattern = pattern, .notify = notify };
+    if (patterns[pattern].policy == ACTUATOR_PREEMPT) {
+        return submit_preempt(&job);
+    }
+
+    // 병합: 같은 패턴이 이미 재생/대기 중이면 새로 쌓지 않음 (오답 연타 등)
+    pthread_mutex_lock(&act_lock);
+    ActuatorJob *same = NULL;
+    if (act_playing && !act_preempt && act_current.pattern == pattern) {
+        same = &act_current;
+    }
+    for (int i = 0; i < act_count && !same; ++i) {
+        ActuatorJob *queued = &act_queue[(act_head + i) % ACTUATOR_QUEUE_LEN];
+        if (queued->pattern == pattern) {
+            same = queued;
+        }
+    }
+
+    unsigned int id = 0;
+    if (same) {
+        same->notify |= notify;
+        act_stats.merged++;
+        id = same->id;
+    } else if (act_count < ACTUATOR_QUEUE_LEN) {
+        id = push_locked(&job);
+    }
+    pthread_mutex_unlock(&act_lock);
+    return id;
+}
+
+unsigned int actuator_play_steps(const ToneStep *steps, int count, int notify) {
+    if (!act_started || count <= 0 || count > ACTUATOR_MAX_STEPS) return 0;
+
+    ActuatorJob job = { .pattern = BUZZER_PATTERN_CUSTOM, .notify = notify, .count = count };
+    memcpy(job.steps, steps, sizeof(ToneStep) * count);
+    return submit_preempt(&job);
+}
+
+void actuator_hold(int freq) {
+    if (!act_started) return;
+
+    ActuatorJob job = { .pattern = HOLD_PATTERN, .hold_freq = freq < 0 ? 0 : freq };
+    submit_preempt(&job);
+}
+
+void actuator_get_stats(ActuatorStats *out) {
+    pthread_mutex_lock(&act_lock);
+    *out = act_stats;
+    out->avg_jitter_us = act_stats.steps ? (long)(act_jitter_sum_us / (long long)act_stats.steps) : 0;
+    pthread_mutex_unlock(&act_lock);
+}
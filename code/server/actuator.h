@@ -0,0 +1,77 @@
+// 부저 액추에이터(톤 시퀀서) 작업 스레드 헤더
+// 명령 처리 경로는 패턴 재생을 요청만 하고 즉시 반환하며, 전용 스레드가 음 길이를 지켜 재생한다.
+// 새 요청은 패턴별 정책에 따라 재생 중인 패턴을 선점하거나 같은 패턴과 병합된다.
+
+#ifndef SERVER_ACTUATOR_H
+#define SERVER_ACTUATOR_H
+
+#define ACTUATOR_MAX_STEPS    32   // 패턴 하나의 최대 음 수
+#define ACTUATOR_MAX_PATTERNS 16   // 내장 + 설정 파일 패턴 최대 수 (번호 1 ~ 15)
+
+// 기본 내장 패턴 번호 (설정 파일에서 같은 이름으로 다시 정의 가능)
+typedef enum BuzzerPattern {
+    BUZZER_PATTERN_CUSTOM = -1,  // BUZZER_PLAY로 받은 일회성 시퀀스
+    BUZZER_PATTERN_WARNING = 1,  // 0.2초 경고음 (440Hz)
+    BUZZER_PATTERN_EMERGENCY,    // 0.2초 비상음 (880Hz)
+    BUZZER_PATTERN_SUCCESS,      // 도-미-솔-도
+    BUZZER_PATTERN_FAIL,         // 미-도-솔(낮은)
+    BUZZER_PATTERN_ALARM,        // 카운트다운 종료 0.5초 (440Hz)
+    BUZZER_PATTERN_COUNT
+} BuzzerPattern;
+
+typedef enum ActuatorResult {
+    ACTUATOR_COMPLETE,   // 끝까지 재생됨
+    ACTUATOR_PREEMPTED   // 새 패턴(또는 BUZZER_ON/OFF)에 의해 중단/취소됨
+} ActuatorResult;
+
+typedef struct ToneStep {
+    int freq;         // Hz (0 = 쉼표)
+    int duration_ms;  // 음 길이 (-1 = 선점될 때까지 유지, 내부용)
+} ToneStep;
+
+// 음 시작 시각 오차 통계 (예정 시각 대비 실제 주파수 설정 시각)
+typedef struct ActuatorStats {
+    unsigned long steps;          // 재생한 음 수
+    unsigned long late_over_1ms;  // 1ms 넘게 늦은 음 수
+    long avg_jitter_us;
+    long max_jitter_us;
+    long last_jitter_us;
+    unsigned long merged;         // 병합된 요청 수
+    unsigned long preempted;      // 선점/취소된 작업 수
+} ActuatorStats;
+
+// 주파수 설정 (0 = 무음), 작업 스레드에서만 호출됨
+typedef void (*actuator_tone_fn)(int freq);
+// 알림을 요청한 작업이 끝났을 때 작업 스레드(또는 선점한 요청 스레드)에서 호출됨
+typedef void (*actuator_done_fn)(unsigned int job_id, int pattern, ActuatorResult result);
+
+// 설정 파일의 패턴 표 적재 (actuator_start 전에 호출), 반환값: 적재한 패턴 수, 파일 없음 = -1
+// 형식: 한 줄에 "이름 merge|preempt 주파수:길이ms,주파수:길이ms,..." ('#'으로 시작하면 주석)
+int actuator_load_patterns(const char *path);
+
+int actuator_start(actuator_tone_fn tone, actuator_done_fn done);
+void actuator_stop(void);
+
+// 패턴 재생 요청 (블로킹 없음). notify가 1이면 종료 시 done 콜백 호출
+// 반환값: 작업 번호 (같은 패턴에 병합되면 기존 작업 번호), 0 = 대기 큐 포화 또는 잘못된 패턴
+unsigned int actuator_play(int pattern, int notify);
+
+// 일회성 시퀀스 재생 요청 (선점 정책), 반환값은 actuator_play와 동일
+unsigned int actuator_play_steps(const ToneStep *steps, int count, int notify);
+
+// 재생 중/대기 중인 패턴을 모두 선점하고 주파수 유지 (freq 0 = 무음), BUZZER_ON/OFF용
+// 유지는 다음 재생 요청(병합 정책 포함)이 들어오면 끝나고 그 패턴으로 넘어감
+void actuator_hold(int freq);
+
+// "주파수:길이ms,..." 문자열 파싱, 반환값: 음 수 (형식 오류 = -1)
+int actuator_parse_steps(const char *text, ToneStep *out, int max);
+
+// 이름으로 패턴 번호 검색 (없으면 0)
+int actuator_find_pattern(const char *name);
+
+// 패턴 이름 ("warning" 등), 잘못된 번호이면 NULL
+const char *actuator_pattern_name(int pattern);
+
+void actuator_get_stats(ActuatorStats *out);
+
+#endif // SERVER_ACTUATOR_H
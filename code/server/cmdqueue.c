@@ -0,0 +1,86 @@
+// 리액터 → 장치 소유 스레드 명령 큐 (Vyukov 내장 노드 MPSC 큐)
+// - 생산자는 head를 원자 교환해 자리를 잡은 뒤 이전 노드의 next를 이어 붙임 (CAS 재시도 없음)
+// - 소비자는 tail부터 next를 따라가며 꺼내고, 마지막 노드는 stub을 다시 넣어 분리
+// - 깨우기: signaled가 0 → 1로 바뀐 생산자만 eventfd에 씀, 소비자는 비우기 전에 0으로 되돌림
+
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "cmdqueue.h"
+
+static void link_node(CmdQueue *q, CmdQueueNode *node)
+{
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    CmdQueueNode *prev = atomic_exchange_explicit(&q->head, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+static void signal_consumer(CmdQueue *q)
+{
+    if (atomic_exchange(&q->signaled, 1) == 0) {
+        uint64_t one = 1;
+        if (write(q->wake_fd, &one, sizeof(one)) < 0) {
+            // 카운터 포화(EAGAIN)는 이미 깨울 예정이라는 뜻
+        }
+    }
+}
+
+int cmdqueue_init(CmdQueue *q)
+{
+    atomic_init(&q->stub.next, NULL);
+    atomic_init(&q->head, &q->stub);
+    q->tail = &q->stub;
+    atomic_init(&q->signaled, 0);
+    q->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return q->wake_fd < 0 ? -1 : 0;
+}
+
+void cmdqueue_push(CmdQueue *q, CmdQueueNode *node)
+{
+    link_node(q, node);
+    signal_consumer(q);
+}
+
+void cmdqueue_begin_drain(CmdQueue *q)
+{
+    uint64_t counter;
+    if (read(q->wake_fd, &counter, sizeof(counter)) < 0) {
+        // 논블로킹 eventfd: 이미 비워진 경우
+    }
+    atomic_store(&q->signaled, 0);
+}
+
+CmdQueueNode *cmdqueue_pop(CmdQueue *q)
+{
+    CmdQueueNode *tail = q->tail;
+    CmdQueueNode *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    if (tail == &q->stub) {
+        if (!next) return NULL;
+        q->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+    if (next) {
+        q->tail = next;
+        return tail;
+    }
+
+    // tail이 마지막 노드처럼 보임: 생산자가 이어 붙이는 중이면 다음에 다시 시도
+    if (tail != atomic_load_explicit(&q->head, memory_order_acquire)) {
+        return NULL;
+    }
+    link_node(q, &q->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next) {
+        q->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+void cmdqueue_rearm(CmdQueue *q)
+{
+    signal_consumer(q);
+}
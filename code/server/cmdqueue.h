@@ -0,0 +1,40 @@
+// 리액터 → 장치 소유 스레드 명령 큐 헤더
+// 여러 리액터 스레드가 받은 명령 프레임을 장치 소유 스레드(I/O 루프) 하나에게 넘기는 잠금 없는 MPSC 큐이다.
+// 노드는 호출부 구조체에 내장하며(할당 없음), 넣기는 원자 교환 한 번, 꺼내기는 소비자 전용이다.
+// 비어 있다가 처음 넣을 때만 eventfd로 소비자를 깨우므로, 연속으로 넣는 동안에는 시스템 호출이 없다.
+
+#ifndef SERVER_CMDQUEUE_H
+#define SERVER_CMDQUEUE_H
+
+#include <stdatomic.h>
+
+typedef struct CmdQueueNode {
+    struct CmdQueueNode *_Atomic next;
+} CmdQueueNode;
+
+typedef struct CmdQueue {
+    CmdQueueNode *_Atomic head;  // 마지막으로 넣은 노드 (생산자)
+    CmdQueueNode *tail;          // 다음에 꺼낼 노드 (소비자 전용)
+    CmdQueueNode stub;           // 빈 큐 표식 (큐 구조체를 옮기면 안 됨)
+    atomic_int signaled;         // 소비자를 깨운 뒤 아직 비우기 시작하지 않았으면 1
+    int wake_fd;                 // 소비자가 epoll에 등록하는 eventfd
+} CmdQueue;
+
+// 초기화 (eventfd 생성), 실패 시 -1
+int cmdqueue_init(CmdQueue *q);
+
+// 생산자: 노드 추가 후 필요하면 소비자를 깨움 (어느 스레드에서든 호출 가능)
+void cmdqueue_push(CmdQueue *q, CmdQueueNode *node);
+
+// 소비자: wake_fd가 읽기 가능하면 먼저 호출한 뒤 cmdqueue_pop으로 비움
+// (이 호출 이후에 들어온 노드는 다시 깨우므로 놓치지 않음)
+void cmdqueue_begin_drain(CmdQueue *q);
+
+// 소비자: 가장 오래된 노드 꺼내기, 비었으면 NULL
+// (생산자가 넣는 도중이면 NULL을 돌려줄 수 있으나, 그 생산자가 넣기를 마치면서 다시 깨움)
+CmdQueueNode *cmdqueue_pop(CmdQueue *q);
+
+// 소비자: 한 번에 다 비우지 못했을 때 다음 루프에서 이어서 처리하도록 스스로 깨움
+void cmdqueue_rearm(CmdQueue *q);
+
+#endif // SERVER_CMDQUEUE_H
@@ -0,0 +1,186 @@
+// 서버 교체 핸드오프 채널 (Unix SOCK_SEQPACKET + SCM_RIGHTS)
+// - 메시지 단위로 송수신하므로 레코드가 나뉘거나 합쳐지지 않고, 붙인 fd도 해당 레코드와 함께 도착
+// - 수신한 fd는 MSG_CMSG_CLOEXEC로 받아 이후 실행하는 프로세스에 새지 않음
+// - 양쪽 모두 블로킹 소켓 + 시간 제한: 교체는 드문 관리 작업이라 I/O 루프가 잠시 멈추는 것을 허용
+
+#define _GNU_SOURCE  // struct ucred, MSG_CMSG_CLOEXEC
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "handoff.h"
+
+static int fill_address(const char *path, struct sockaddr_un *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr->sun_path, path);
+    return 0;
+}
+
+static void set_timeouts(int fd)
+{
+    struct timeval tv = { HANDOFF_TIMEOUT_MS / 1000, (HANDOFF_TIMEOUT_MS % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+int handoff_listen(const char *path)
+{
+    struct sockaddr_un addr;
+    if (fill_address(path, &addr) < 0) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    // 교체 중이면 이전 서버가 같은 경로를 쓰고 있지만, 이전 서버는 곧 종료하므로 경로를 넘겨받음
+    unlink(path);
+    mode_t old_mask = umask(077);
+    int rc = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(old_mask);
+    if (rc < 0 || listen(fd, 1) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int handoff_accept(int listen_fd, pid_t *peer_pid)
+{
+    int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0) return -1;
+
+    // 같은 사용자(보통 root)가 띄운 프로세스에만 소켓을 넘김
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0 || cred.uid != geteuid()) {
+        close(fd);
+        errno = EPERM;
+        return -1;
+    }
+    if (peer_pid) *peer_pid = cred.pid;
+    set_timeouts(fd);
+    return fd;
+}
+
+int handoff_connect(const char *path)
+{
+    struct sockaddr_un addr;
+    if (fill_address(path, &addr) < 0) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    set_timeouts(fd);
+    return fd;
+}
+
+int handoff_send(int fd, const void *msg, size_t len, const int *fds, int nfds)
+{
+    if (nfds < 0 || nfds > HANDOFF_MAX_FDS) return -1;
+
+    struct iovec iov = { (void *)msg, len };
+    union {
+        char buf[CMSG_SPACE(sizeof(int) * HANDOFF_MAX_FDS)];
+        struct cmsghdr align;
+    } control;
+    struct msghdr mh;
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    if (nfds > 0) {
+        memset(&control, 0, sizeof(control));
+        mh.msg_control = control.buf;
+        mh.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+        struct cmsghdr *cm = CMSG_FIRSTHDR(&mh);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+        memcpy(CMSG_DATA(cm), fds, sizeof(int) * nfds);
+    }
+
+    ssize_t n;
+    do {
+        n = sendmsg(fd, &mh, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    return n == (ssize_t)len ? 0 : -1;
+}
+
+ssize_t handoff_recv(int fd, void *msg, size_t size, int *fds, int *nfds)
+{
+    int capacity = nfds ? *nfds : 0;
+    if (nfds) *nfds = 0;
+
+    struct iovec iov = { msg, size };
+    union {
+        char buf[CMSG_SPACE(sizeof(int) * HANDOFF_MAX_FDS)];
+        struct cmsghdr align;
+    } control;
+    struct msghdr mh;
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = control.buf;
+    mh.msg_controllen = sizeof(control.buf);
+
+    ssize_t n;
+    do {
+        n = recvmsg(fd, &mh, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) return -1;
+
+    // 받은 fd는 결과와 관계없이 모두 꺼내고, 담을 곳이 없는 것은 닫음
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(&mh); cm; cm = CMSG_NXTHDR(&mh, cm)) {
+        if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS) continue;
+        int count = (int)((cm->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        for (int i = 0; i < count; ++i) {
+            int received;
+            memcpy(&received, CMSG_DATA(cm) + sizeof(int) * i, sizeof(int));
+            if (nfds && *nfds < capacity) {
+                fds[(*nfds)++] = received;
+            } else {
+                close(received);
+            }
+        }
+    }
+    if (mh.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) {
+        return -1;
+    }
+    return n;
+}
+
+int handoff_send_data(int fd, const void *data, size_t len)
+{
+    const char *p = data;
+    while (len > 0) {
+        size_t chunk = len < HANDOFF_CHUNK ? len : HANDOFF_CHUNK;
+        if (handoff_send(fd, p, chunk, NULL, 0) < 0) return -1;
+        p += chunk;
+        len -= chunk;
+    }
+    return 0;
+}
+
+int handoff_recv_data(int fd, void *data, size_t len)
+{
+    char *p = data;
+    while (len > 0) {
+        size_t chunk = len < HANDOFF_CHUNK ? len : HANDOFF_CHUNK;
+        if (handoff_recv(fd, p, chunk, NULL, NULL) != (ssize_t)chunk) return -1;
+        p += chunk;
+        len -= chunk;
+    }
+    return 0;
+}
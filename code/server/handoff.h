@@ -0,0 +1,37 @@
+// 서버 교체(업그레이드) 핸드오프 채널 헤더
+// 실행 중인 서버는 Unix SOCK_SEQPACKET 소켓에서 새 서버 프로세스의 연결을 기다렸다가
+// 리스닝 소켓과 클라이언트 소켓 fd를 SCM_RIGHTS로 넘긴다. 메시지 경계가 유지되므로 레코드 하나 = 메시지 하나이고,
+// fd는 해당 레코드 메시지에 붙여 보낸다. 레코드 형식(무엇을 넘기는지)은 server.c가 정하고 여기서는 전송만 담당한다.
+
+#ifndef SERVER_HANDOFF_H
+#define SERVER_HANDOFF_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define HANDOFF_CHUNK 16384        // 큰 데이터(미전송 응답 등)는 이 크기 메시지로 나눠 보냄
+#define HANDOFF_MAX_FDS 32         // 메시지 하나에 붙일 수 있는 최대 fd 수 (리액터별 리스닝 소켓 + 지표 포트)
+#define HANDOFF_TIMEOUT_MS 5000    // 상대가 응답하지 않을 때 포기하는 시간
+
+// 교체 요청을 받을 소켓 생성 (남아 있는 파일은 지우고 새로 bind, 소유자만 접근), 실패 시 -1
+int handoff_listen(const char *path);
+
+// 교체 요청 수락: 같은 사용자의 프로세스만 허용, 반환 fd는 블로킹 + HANDOFF_TIMEOUT_MS 시간 제한
+// peer_pid: 요청한 프로세스 PID (NULL 가능)
+int handoff_accept(int listen_fd, pid_t *peer_pid);
+
+// 실행 중인 서버에 연결 (시간 제한 설정), 실패 시 -1
+int handoff_connect(const char *path);
+
+// 메시지 하나 전송 (fds가 있으면 함께 전달), 실패 시 -1
+int handoff_send(int fd, const void *msg, size_t len, const int *fds, int nfds);
+
+// 메시지 하나 수신: 받은 fd는 fds[]에 (close-on-exec), *nfds는 입력 = 배열 크기, 출력 = 받은 수
+// 반환값: 받은 길이 (연결 종료 0, 실패 또는 메시지가 size보다 길면 -1)
+ssize_t handoff_recv(int fd, void *msg, size_t size, int *fds, int *nfds);
+
+// len 바이트를 HANDOFF_CHUNK 단위 메시지로 나눠 송수신 (len이 0이면 아무것도 하지 않음)
+int handoff_send_data(int fd, const void *data, size_t len);
+int handoff_recv_data(int fd, void *data, size_t len);
+
+#endif // SERVER_HANDOFF_H
@@ -0,0 +1,252 @@
+// 장치 상태 저널 (mmap 파일)
+// - 파일 = 헤더 한 페이지 + 고정 크기 레코드 링. 처음 열 때 전체 크기를 미리 할당하고 계속 매핑해 둠
+// - 레코드는 번호 순서대로 이어 쓰고, 각 레코드의 체크섬으로 쓰다 만 레코드를 가려냄
+// - 체크포인트(그 시점의 상태와 레코드 번호)는 헤더의 두 칸에 번갈아 기록하여 하나가 깨져도 다른 하나로 복원
+// - 복원: 최신 체크포인트에서 시작해 번호가 이어지는 레코드만 따라감 (최대 JOURNAL_CHECKPOINT_RECORDS개 정도)
+// - 매핑된 페이지는 프로세스가 비정상 종료되어도 커널에 남으므로, 평소에는 체크포인트 때 비동기 msync만 요청
+
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "journal.h"
+
+#define JOURNAL_MAGIC 0x4C4E524AU  // "JRNL"
+#define JOURNAL_VERSION 1
+#define JOURNAL_HEADER_SIZE 4096   // 레코드 링이 페이지 경계에서 시작하도록 헤더 영역을 한 페이지로 둠
+
+typedef struct JournalCheckpoint {
+    uint64_t seq;           // 이 번호의 레코드까지 반영한 상태 (0 = 기록 전)
+    uint64_t time_ms;
+    int32_t led_level;
+    int32_t segment_digit;
+    uint32_t reserved;
+    uint32_t checksum;
+} JournalCheckpoint;
+
+typedef struct JournalHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t capacity;
+    JournalCheckpoint checkpoints[2];
+} JournalHeader;
+
+_Static_assert(sizeof(JournalRecord) == 32, "JournalRecord 크기가 파일 형식과 다름");
+_Static_assert(sizeof(JournalHeader) <= JOURNAL_HEADER_SIZE, "JournalHeader가 헤더 영역보다 큼");
+_Static_assert(JOURNAL_CHECKPOINT_RECORDS < JOURNAL_CAPACITY, "체크포인트 간격이 링보다 길면 복원할 레코드가 덮어써짐");
+
+#define JOURNAL_FILE_SIZE (JOURNAL_HEADER_SIZE + sizeof(JournalRecord) * JOURNAL_CAPACITY)
+
+static int journal_fd = -1;
+static void *journal_map = NULL;
+static JournalHeader *header = NULL;
+static JournalRecord *records = NULL;
+
+// 마지막으로 기록한 레코드 (다음 체크포인트 내용)
+static uint64_t last_seq = 0;
+static uint64_t last_time_ms = 0;
+static int last_led = -1;
+static int last_segment = -1;
+static int since_checkpoint = 0;
+
+static uint32_t fnv1a(const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static uint32_t record_checksum(const JournalRecord *r)
+{
+    return fnv1a(r, offsetof(JournalRecord, checksum));
+}
+
+static uint32_t checkpoint_checksum(const JournalCheckpoint *cp)
+{
+    return fnv1a(cp, offsetof(JournalCheckpoint, checksum));
+}
+
+static int checkpoint_valid(const JournalCheckpoint *cp)
+{
+    return cp->seq != 0 && cp->checksum == checkpoint_checksum(cp);
+}
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+// 유효한 체크포인트 중 최신 것 (없으면 NULL)
+static const JournalCheckpoint *latest_checkpoint(void)
+{
+    const JournalCheckpoint *best = NULL;
+    for (int i = 0; i < 2; ++i) {
+        const JournalCheckpoint *cp = &header->checkpoints[i];
+        if (checkpoint_valid(cp) && (!best || cp->seq > best->seq)) {
+            best = cp;
+        }
+    }
+    return best;
+}
+
+// 현재 상태를 체크포인트로 기록: 깨졌거나 더 오래된 칸을 덮어씀
+static void checkpoint(void)
+{
+    since_checkpoint = 0;
+    if (!header || last_seq == 0) return;
+    const JournalCheckpoint *latest = latest_checkpoint();
+    if (latest && latest->seq == last_seq) return;
+
+    JournalCheckpoint *slots = header->checkpoints;
+    JournalCheckpoint *cp;
+    if (!checkpoint_valid(&slots[0])) {
+        cp = &slots[0];
+    } else if (!checkpoint_valid(&slots[1])) {
+        cp = &slots[1];
+    } else {
+        cp = slots[0].seq <= slots[1].seq ? &slots[0] : &slots[1];
+    }
+
+    JournalCheckpoint next;
+    memset(&next, 0, sizeof(next));
+    next.seq = last_seq;
+    next.time_ms = last_time_ms;
+    next.led_level = last_led;
+    next.segment_digit = last_segment;
+    next.checksum = checkpoint_checksum(&next);
+    *cp = next;
+
+    // 디스크 반영은 커널에 맡김 (I/O 루프를 막지 않음)
+    msync(journal_map, JOURNAL_FILE_SIZE, MS_ASYNC);
+}
+
+static void format_new(void)
+{
+    memset(journal_map, 0, JOURNAL_FILE_SIZE);
+    header->magic = JOURNAL_MAGIC;
+    header->version = JOURNAL_VERSION;
+    header->record_size = sizeof(JournalRecord);
+    header->capacity = JOURNAL_CAPACITY;
+    msync(journal_map, JOURNAL_FILE_SIZE, MS_SYNC);
+}
+
+int journal_open(const char *path, JournalState *restored)
+{
+    memset(restored, 0, sizeof(*restored));
+    restored->led_level = -1;
+    restored->segment_digit = -1;
+    if (journal_map) return -1;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    int fresh = fstat(fd, &st) < 0 || st.st_size != (off_t)JOURNAL_FILE_SIZE;
+    if (fresh) {
+        // 파일 블록을 미리 확보해야 매핑된 페이지에 쓸 때 공간 부족으로 SIGBUS가 나지 않음
+        if (ftruncate(fd, 0) < 0 || posix_fallocate(fd, 0, (off_t)JOURNAL_FILE_SIZE) != 0) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    void *map = mmap(NULL, JOURNAL_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    journal_fd = fd;
+    journal_map = map;
+    header = map;
+    records = (JournalRecord *)((char *)map + JOURNAL_HEADER_SIZE);
+
+    if (!fresh && (header->magic != JOURNAL_MAGIC || header->version != JOURNAL_VERSION ||
+                   header->record_size != sizeof(JournalRecord) || header->capacity != JOURNAL_CAPACITY)) {
+        fresh = 1;  // 다른 형식의 파일: 새로 시작
+    }
+    if (fresh) {
+        format_new();
+        return 0;
+    }
+
+    const JournalCheckpoint *cp = latest_checkpoint();
+    if (cp) {
+        last_seq = cp->seq;
+        last_time_ms = cp->time_ms;
+        last_led = cp->led_level;
+        last_segment = cp->segment_digit;
+    }
+
+    // 체크포인트 다음 번호부터 체크섬이 맞고 번호가 이어지는 레코드만 반영
+    // (이전 바퀴의 레코드는 번호가 맞지 않고, 쓰다 만 레코드는 체크섬이 맞지 않아 여기서 멈춤)
+    int replayed = 0;
+    while (replayed < JOURNAL_CAPACITY) {
+        const JournalRecord *r = &records[last_seq % JOURNAL_CAPACITY];
+        if (r->seq != last_seq + 1 || r->checksum != record_checksum(r)) break;
+        last_seq = r->seq;
+        last_time_ms = r->time_ms;
+        last_led = r->led_level;
+        last_segment = r->segment_digit;
+        replayed++;
+    }
+    if (replayed > 0) {
+        checkpoint();  // 다음 시작 때는 다시 훑지 않도록
+    }
+
+    restored->led_level = last_led;
+    restored->segment_digit = last_segment;
+    restored->seq = last_seq;
+    restored->time_ms = last_time_ms;
+    restored->replayed = replayed;
+    return last_seq > 0 ? 1 : 0;
+}
+
+void journal_append(JournalSource source, uint8_t opcode, int32_t arg, int led_level, int segment_digit)
+{
+    if (!records) return;
+
+    JournalRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.seq = last_seq + 1;
+    rec.time_ms = now_ms();
+    rec.arg = arg;
+    rec.source = (uint8_t)source;
+    rec.opcode = opcode;
+    rec.led_level = (int8_t)led_level;
+    rec.segment_digit = (int8_t)segment_digit;
+    rec.checksum = record_checksum(&rec);
+    records[last_seq % JOURNAL_CAPACITY] = rec;
+
+    last_seq = rec.seq;
+    last_time_ms = rec.time_ms;
+    last_led = led_level;
+    last_segment = segment_digit;
+
+    if (++since_checkpoint >= JOURNAL_CHECKPOINT_RECORDS) {
+        checkpoint();
+    }
+}
+
+void journal_close(void)
+{
+    if (!journal_map) return;
+    checkpoint();
+    msync(journal_map, JOURNAL_FILE_SIZE, MS_SYNC);
+    munmap(journal_map, JOURNAL_FILE_SIZE);
+    close(journal_fd);
+    journal_map = NULL;
+    header = NULL;
+    records = NULL;
+    journal_fd = -1;
+}
@@ -0,0 +1,53 @@
+// 장치 상태 저널 헤더
+// 상태를 바꾼 명령/이벤트와 그 결과 장치 상태를 고정 크기 레코드로 mmap 파일에 이어 쓰고,
+// 일정 레코드마다 체크포인트를 남긴다. 재시작 시 마지막 체크포인트 이후 레코드만 훑어
+// 마지막 LED/7SEG 상태를 복원한다. 모든 함수는 I/O 루프 스레드에서만 호출한다 (잠금 없음).
+
+#ifndef SERVER_JOURNAL_H
+#define SERVER_JOURNAL_H
+
+#include <stdint.h>
+
+#define JOURNAL_CAPACITY 1024          // 레코드 링 크기 (가장 오래된 레코드부터 덮어씀)
+#define JOURNAL_CHECKPOINT_RECORDS 64  // 이 수만큼 추가할 때마다 체크포인트 (링 크기보다 작아야 함)
+
+// 상태 변화의 원인
+typedef enum JournalSource {
+    JOURNAL_SRC_EVENT   = 0,  // 타이머/센서에 의한 자동 변화 (카운트다운, 퀴즈, CDS 모니터)
+    JOURNAL_SRC_COMMAND = 1,  // 클라이언트 명령
+    JOURNAL_SRC_RESTORE = 2   // 시작 시 저널로부터 복원
+} JournalSource;
+
+// 파일에 그대로 저장되는 레코드 (32바이트)
+typedef struct JournalRecord {
+    uint64_t seq;           // 1부터 증가 (0 = 빈 슬롯), 링 위치 = (seq - 1) % JOURNAL_CAPACITY
+    uint64_t time_ms;       // 벽시계 시각 (밀리초)
+    int32_t arg;            // 명령 인자
+    uint8_t source;         // JournalSource
+    uint8_t opcode;         // 명령 코드 (PROTO_OP_*, 명령이 아니거나 텍스트 전용이면 0)
+    int8_t led_level;       // 결과 LED 밝기 (-1 = 알 수 없음)
+    int8_t segment_digit;   // 결과 7SEG 숫자 (-1 = 알 수 없음)
+    uint32_t reserved;
+    uint32_t checksum;      // 앞 28바이트의 FNV-1a (찢어진 쓰기 감지)
+} JournalRecord;
+
+// 복원 결과
+typedef struct JournalState {
+    int led_level;
+    int segment_digit;
+    uint64_t seq;           // 마지막 유효 레코드 번호 (0 = 기록 없음)
+    uint64_t time_ms;       // 그 레코드 시각
+    int replayed;           // 체크포인트 이후 훑은 레코드 수
+} JournalState;
+
+// 저널 파일 열기 (없거나 형식이 다르면 새로 만듦) 및 마지막 상태 읽기
+// 반환값: 1 = 복원할 상태 있음, 0 = 새 저널, -1 = 실패 (이후 추가는 무시됨)
+int journal_open(const char *path, JournalState *restored);
+
+// 레코드 추가 (열려 있지 않으면 무시), JOURNAL_CHECKPOINT_RECORDS마다 체크포인트
+void journal_append(JournalSource source, uint8_t opcode, int32_t arg, int led_level, int segment_digit);
+
+// 즉시 체크포인트 후 저널 닫기 (종료 시)
+void journal_close(void);
+
+#endif // SERVER_JOURNAL_H
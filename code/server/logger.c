@@ -0,0 +1,300 @@
+// 서버 비동기 로그 백엔드
+// - 고정 크기 락 없는 MPSC 큐 (Vyukov bounded queue): 명령 처리 경로는 enqueue 비용만 지불
+// - 전용 기록 스레드가 로그 파일을 열어 둔 채 큐를 비우며 묶음 단위로 fflush
+// - 파일 크기가 LOG_MAX_FILE_SIZE를 넘으면 device_server.log.1 ~ .N 으로 순환
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+
+#include "logger.h"
+
+#define LOG_QUEUE_SIZE     1024              // 큐 슬롯 수 (2의 거듭제곱)
+#define LOG_MSG_SIZE       512               // 메시지 최대 길이
+#define LOG_MAX_FILE_SIZE  (1024 * 1024)     // 순환 기준 크기 (1MB)
+#define LOG_MAX_BACKUPS    3                 // 보관할 순환 파일 수 (.1 ~ .3)
+#define LOG_FILE_BUFFER    (64 * 1024)       // stdio 버퍼 크기
+
+typedef struct LogSlot {
+    atomic_size_t seq;      // 슬롯 상태 (Vyukov 시퀀스 번호)
+    int level;
+    time_t timestamp;       // enqueue 시점 (벽시계)
+    char msg[LOG_MSG_SIZE];
+} LogSlot;
+
+static LogSlot log_queue[LOG_QUEUE_SIZE];
+static atomic_size_t enqueue_pos;
+static size_t dequeue_pos;                   // 소비자(기록 스레드) 전용
+
+static atomic_int min_level = LOG_LEVEL_INFO;
+static atomic_ulong dropped_count;           // 큐 포화로 버려진 메시지 수
+static atomic_int writer_sleeping;           // 기록 스레드가 eventfd에서 대기 중인지 여부
+static atomic_int stopping;
+
+static int wake_fd = -1;
+static pthread_t writer_thread;
+static int writer_started = 0;
+
+static char log_path[2048];
+static FILE *log_fp = NULL;
+static long log_size = 0;
+
+static const char *level_names[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+// 큐 슬롯 시퀀스 초기화 (프로그램 시작 시 1회, 최초 enqueue 이전)
+static void __attribute__((constructor)) init_queue(void) {
+    for (size_t i = 0; i < LOG_QUEUE_SIZE; ++i) {
+        atomic_init(&log_queue[i].seq, i);
+    }
+    atomic_init(&enqueue_pos, 0);
+    dequeue_pos = 0;
+}
+
+// 생산자: 슬롯 하나를 예약하여 메시지 복사 후 게시 (큐가 가득 차면 -1)
+static int enqueue(int level, const char *msg) {
+    size_t pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+    LogSlot *slot;
+
+    while (1) {
+        slot = &log_queue[pos & (LOG_QUEUE_SIZE - 1)];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1;  // 가득 참
+        } else {
+            pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->timestamp = time(NULL);
+    strncpy(slot->msg, msg, LOG_MSG_SIZE - 1);
+    slot->msg[LOG_MSG_SIZE - 1] = '\0';
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return 0;
+}
+
+// 소비자: 게시된 슬롯이 있으면 반환 (호출자가 처리 후 release_slot 호출)
+static LogSlot *peek_slot(void) {
+    LogSlot *slot = &log_queue[dequeue_pos & (LOG_QUEUE_SIZE - 1)];
+    size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    return (seq == dequeue_pos + 1) ? slot : NULL;
+}
+
+static void release_slot(LogSlot *slot) {
+    atomic_store_explicit(&slot->seq, dequeue_pos + LOG_QUEUE_SIZE, memory_order_release);
+    dequeue_pos++;
+}
+
+static void open_log_file(void) {
+    log_fp = fopen(log_path, "a");
+    if (!log_fp) {
+        return;
+    }
+    setvbuf(log_fp, NULL, _IOFBF, LOG_FILE_BUFFER);
+    fseek(log_fp, 0, SEEK_END);
+    log_size = ftell(log_fp);
+    if (log_size < 0) log_size = 0;
+}
+
+// 크기 기준 순환: log.2 → log.3, log.1 → log.2, log → log.1 후 새 파일 열기
+static void rotate_log_file(void) {
+    char from[2100], to[2100];
+
+    fclose(log_fp);
+    log_fp = NULL;
+
+    for (int i = LOG_MAX_BACKUPS - 1; i >= 1; --i) {
+        snprintf(from, sizeof(from), "%s.%d", log_path, i);
+        snprintf(to, sizeof(to), "%s.%d", log_path, i + 1);
+        rename(from, to);
+    }
+    snprintf(to, sizeof(to), "%s.1", log_path);
+    rename(log_path, to);
+
+    open_log_file();
+}
+
+static void write_line(int level, time_t timestamp, const char *msg) {
+    static time_t cached_time = (time_t)-1;
+    static struct tm cached_tm;
+    int written;
+
+    // 같은 초의 메시지는 localtime_r 결과 재사용
+    if (timestamp != cached_time) {
+        localtime_r(&timestamp, &cached_tm);
+        cached_time = timestamp;
+    }
+
+    // INFO는 기존 로그 형식 유지, 그 외 레벨만 태그 표시
+    if (level == LOG_LEVEL_INFO) {
+        written = fprintf(log_fp, "[%02d:%02d:%02d] %s\n",
+                          cached_tm.tm_hour, cached_tm.tm_min, cached_tm.tm_sec, msg);
+    } else {
+        written = fprintf(log_fp, "[%02d:%02d:%02d] [%s] %s\n",
+                          cached_tm.tm_hour, cached_tm.tm_min, cached_tm.tm_sec,
+                          level_names[level], msg);
+    }
+    if (written > 0) {
+        log_size += written;
+    }
+}
+
+// 큐에 쌓인 메시지를 한 번에 기록하고 1회만 flush
+static void drain_queue(void) {
+    LogSlot *slot;
+    int batch = 0;
+
+    if (!log_fp) {
+        open_log_file();  // 이전에 열기 실패했다면 재시도
+    }
+
+    while ((slot = peek_slot()) != NULL) {
+        if (log_fp) {
+            write_line(slot->level, slot->timestamp, slot->msg);
+        }
+        release_slot(slot);
+        batch++;
+    }
+
+    unsigned long dropped = atomic_exchange(&dropped_count, 0);
+    if (dropped > 0 && log_fp) {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "로그 큐 포화로 메시지 %lu개 누락", dropped);
+        write_line(LOG_LEVEL_WARN, time(NULL), msg);
+        batch++;
+    }
+
+    if (batch > 0 && log_fp) {
+        fflush(log_fp);
+        if (log_size >= LOG_MAX_FILE_SIZE) {
+            rotate_log_file();
+        }
+    }
+}
+
+// 기록 스레드: 큐가 비면 eventfd에서 잠들었다가 생산자가 깨우면 다시 비움
+static void *logger_thread_func(void *arg) {
+    (void)arg;
+    uint64_t counter;
+
+    while (1) {
+        drain_queue();
+
+        if (atomic_load(&stopping)) {
+            drain_queue();
+            break;
+        }
+
+        atomic_store(&writer_sleeping, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (peek_slot() != NULL || atomic_load(&stopping)) {
+            atomic_store(&writer_sleeping, 0);
+            continue;
+        }
+        if (read(wake_fd, &counter, sizeof(counter)) < 0 && errno != EINTR) {
+            usleep(10000);  // eventfd 오류 시에도 바쁜 대기는 피함
+        }
+        atomic_store(&writer_sleeping, 0);
+    }
+
+    if (log_fp) {
+        fclose(log_fp);
+        log_fp = NULL;
+    }
+    return NULL;
+}
+
+static void wake_writer(void) {
+    uint64_t one = 1;
+    atomic_thread_fence(memory_order_seq_cst);
+    if (wake_fd >= 0 && atomic_exchange(&writer_sleeping, 0)) {
+        if (write(wake_fd, &one, sizeof(one)) < 0) {
+            // 이미 깨울 신호가 쌓여 있는 경우 등은 무시
+        }
+    }
+}
+
+int logger_start(const char *path) {
+    if (writer_started) return 0;
+
+    snprintf(log_path, sizeof(log_path), "%s", path);
+    wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        return -1;
+    }
+
+    // 기록 스레드는 시그널을 받지 않도록 모든 시그널을 막은 채 생성
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+
+    atomic_store(&stopping, 0);
+    int rc = pthread_create(&writer_thread, NULL, logger_thread_func, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc != 0) {
+        close(wake_fd);
+        wake_fd = -1;
+        return -1;
+    }
+    writer_started = 1;
+    return 0;
+}
+
+void logger_stop(void) {
+    if (!writer_started) return;
+
+    atomic_store(&stopping, 1);
+    atomic_store(&writer_sleeping, 1);  // 대기 여부와 관계없이 강제로 깨움
+    wake_writer();
+    pthread_join(writer_thread, NULL);
+    writer_started = 0;
+
+    close(wake_fd);
+    wake_fd = -1;
+}
+
+void logger_set_level(LogLevel level) {
+    atomic_store(&min_level, level);
+}
+
+int logger_parse_level(const char *name) {
+    static const char *const names[] = { "debug", "info", "warn", "error" };
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); ++i) {
+        if (strcasecmp(name, names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+int logger_enabled(LogLevel level) {
+    return (int)level >= atomic_load_explicit(&min_level, memory_order_relaxed);
+}
+
+void log_event_level(LogLevel level, const char *msg) {
+    if (!msg || !logger_enabled(level)) return;
+
+    if (enqueue(level, msg) < 0) {
+        atomic_fetch_add_explicit(&dropped_count, 1, memory_order_relaxed);
+        return;
+    }
+    wake_writer();
+}
+
+// 로그 기록용 보조 함수 (데몬은 화면 출력이 안 되므로 필수)
+void log_event(const char *msg) {
+    log_event_level(LOG_LEVEL_INFO, msg);
+}
@@ -0,0 +1,33 @@
+// 서버 비동기 로그 백엔드 헤더
+// 호출 스레드는 락 없는 MPSC 큐에 넣기만 하고, 전용 기록 스레드가 파일에 모아서 쓴다.
+
+#ifndef SERVER_LOGGER_H
+#define SERVER_LOGGER_H
+
+typedef enum LogLevel {
+    LOG_LEVEL_DEBUG = 0,
+    LOG_LEVEL_INFO  = 1,
+    LOG_LEVEL_WARN  = 2,
+    LOG_LEVEL_ERROR = 3
+} LogLevel;
+
+// 기록 스레드 시작 (로그 파일을 열어 두고 유지). 데몬 전환(fork) 이후에 호출해야 한다.
+int logger_start(const char *path);
+
+// 큐에 남은 메시지를 모두 기록하고 기록 스레드 종료
+void logger_stop(void);
+
+// 이 레벨 미만의 메시지는 큐에 넣지 않고 버린다 (기본: LOG_LEVEL_INFO)
+void logger_set_level(LogLevel level);
+int logger_enabled(LogLevel level);
+
+// 레벨 이름("debug", "info", "warn", "error", 대소문자 무관)을 레벨로, 모르는 이름이면 -1
+int logger_parse_level(const char *name);
+
+// 메시지를 큐에 넣는다 (큐가 가득 차면 버리고 누락 수만 센다, 블로킹 없음)
+void log_event_level(LogLevel level, const char *msg);
+
+// INFO 레벨 기록 (기존 호출부 호환)
+void log_event(const char *msg);
+
+#endif // SERVER_LOGGER_H
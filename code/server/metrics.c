@@ -0,0 +1,206 @@
+// 운영 지표: 지연 시간 히스토그램과 Prometheus 텍스트 내보내기
+// - 기록은 relaxed 원자 연산 몇 번뿐이라 I/O 루프/액추에이터 스레드의 측정 지점에 그대로 넣을 수 있음
+// - 내보내기 스레드는 요청마다 블로킹으로 읽고 써도 I/O 루프에 영향이 없도록 별도 스레드에서 실행
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "metrics.h"
+
+#define METRICS_BODY_SIZE (256 * 1024)  // 응답 본문 최대 크기
+#define METRICS_READ_TIMEOUT_MS 1000    // 요청 읽기 대기 (느린 수집기가 다음 요청을 오래 막지 않도록)
+
+static int bucket_index(unsigned long us)
+{
+    if (us <= 1) return 0;
+    int index = 64 - __builtin_clzl(us - 1);  // ceil(log2(us))
+    return index < METRICS_BUCKETS - 1 ? index : METRICS_BUCKETS - 1;
+}
+
+void latency_record_since(LatencyHistogram *h, uint64_t start_ns)
+{
+    unsigned long us = (unsigned long)((metrics_now_ns() - start_ns + 999) / 1000);
+
+    atomic_fetch_add_explicit(&h->buckets[bucket_index(us)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum_us, us, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+
+    unsigned long max = atomic_load_explicit(&h->max_us, memory_order_relaxed);
+    while (us > max && !atomic_compare_exchange_weak_explicit(&h->max_us, &max, us, memory_order_relaxed,
+                                                               memory_order_relaxed)) {
+    }
+}
+
+unsigned long latency_percentile_us(const LatencyHistogram *h, double q)
+{
+    unsigned long counts[METRICS_BUCKETS];
+    unsigned long total = 0;
+    for (int i = 0; i < METRICS_BUCKETS; ++i) {
+        counts[i] = atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) return 0;
+
+    unsigned long max = atomic_load_explicit(&h->max_us, memory_order_relaxed);
+    unsigned long rank = (unsigned long)(q * (double)total);
+    if (rank < 1) rank = 1;
+
+    unsigned long seen = 0;
+    for (int i = 0; i < METRICS_BUCKETS - 1; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            unsigned long upper = 1UL << i;
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+void metrics_printf(char *buf, size_t size, size_t *len, const char *fmt, ...)
+{
+    if (*len >= size) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf + *len, size - *len, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    *len = (size_t)n < size - *len ? *len + (size_t)n : size;
+}
+
+void metrics_write_histogram(char *buf, size_t size, size_t *len, const char *name, const char *labels,
+                             const LatencyHistogram *h)
+{
+    const char *sep = labels[0] ? "," : "";
+    char braced[128] = "";  // _sum/_count용 "{labels}" (레이블이 없으면 중괄호도 생략)
+    if (labels[0]) snprintf(braced, sizeof(braced), "{%s}", labels);
+    unsigned long cumulative = 0;
+    for (int i = 0; i < METRICS_BUCKETS - 1; ++i) {
+        cumulative += atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        metrics_printf(buf, size, len, "%s_bucket{%s%sle=\"%g\"} %lu\n", name, labels, sep,
+                       (double)(1UL << i) / 1e6, cumulative);
+    }
+    cumulative += atomic_load_explicit(&h->buckets[METRICS_BUCKETS - 1], memory_order_relaxed);
+    metrics_printf(buf, size, len, "%s_bucket{%s%sle=\"+Inf\"} %lu\n", name, labels, sep, cumulative);
+    metrics_printf(buf, size, len, "%s_sum%s %g\n", name, braced,
+                   (double)atomic_load_explicit(&h->sum_us, memory_order_relaxed) / 1e6);
+    metrics_printf(buf, size, len, "%s_count%s %lu\n", name, braced, cumulative);
+}
+
+// ===== 내보내기 스레드 =====
+
+static int exporter_fd = -1;
+static metrics_render_fn exporter_render = NULL;
+
+static int send_all(int fd, const char *data, size_t len)
+{
+    size_t sent = 0;
+    while (sent < len) {
+        ssize_t n = send(fd, data + sent, len - sent, MSG_NOSIGNAL);
+        if (n <= 0) return -1;
+        sent += (size_t)n;
+    }
+    return 0;
+}
+
+static void serve_one(int fd, char *body)
+{
+    // 요청 헤더는 내용과 관계없이 읽어서 버림 (어떤 경로든 지표를 응답)
+    char request[1024];
+    if (read(fd, request, sizeof(request)) < 0) {
+        // 시간 초과: 그래도 응답
+    }
+
+    size_t body_len = exporter_render(body, METRICS_BODY_SIZE);
+    char head[160];
+    int head_len = snprintf(head, sizeof(head),
+                            "HTTP/1.0 200 OK\r\n"
+                            "Content-Type: text/plain; version=0.0.4\r\n"
+                            "Content-Length: %zu\r\n"
+                            "Connection: close\r\n\r\n", body_len);
+
+    if (send_all(fd, head, (size_t)head_len) == 0 && send_all(fd, body, body_len) == 0) {
+        shutdown(fd, SHUT_WR);
+    }
+}
+
+static void *exporter_thread_func(void *arg)
+{
+    (void)arg;
+    char *body = malloc(METRICS_BODY_SIZE);
+    if (!body) return NULL;
+
+    for (;;) {
+        int fd = accept(exporter_fd, NULL, NULL);
+        if (fd < 0) continue;
+
+        struct timeval tv = { METRICS_READ_TIMEOUT_MS / 1000, (METRICS_READ_TIMEOUT_MS % 1000) * 1000 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        serve_one(fd, body);
+        close(fd);
+    }
+    return NULL;
+}
+
+// 이미 listen 중인 fd로 응답 스레드 시작
+static int exporter_run(int fd, metrics_render_fn render)
+{
+    exporter_fd = fd;
+    exporter_render = render;
+
+    // 작업 스레드는 시그널을 받지 않도록 모든 시그널을 막은 채 생성
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    pthread_t thread;
+    int rc = pthread_create(&thread, NULL, exporter_thread_func, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc != 0) {
+        exporter_fd = -1;
+        return -1;
+    }
+    pthread_detach(thread);
+    return 0;
+}
+
+int metrics_exporter_start(int port, metrics_render_fn render)
+{
+    if (exporter_fd >= 0 || !render) return -1;
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    // 로컬 수집기만 접근 (장치 제어 포트와 달리 외부에 열지 않음)
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 8) < 0 || exporter_run(fd, render) < 0) {
+        close(fd);
+        return -1;
+    }
+    return 0;
+}
+
+int metrics_exporter_adopt(int fd, metrics_render_fn render)
+{
+    if (exporter_fd >= 0 || fd < 0 || !render) return -1;
+    return exporter_run(fd, render);
+}
+
+int metrics_exporter_fd(void)
+{
+    return exporter_fd;
+}
@@ -0,0 +1,56 @@
+// 운영 지표 헤더
+// 지연 시간 히스토그램은 2배 간격 구간의 원자 카운터라 어느 스레드에서든 잠금 없이 기록/읽기 가능하다.
+// 내보내기 스레드는 로컬 포트에서 HTTP 요청을 받을 때마다 render 콜백으로 Prometheus 텍스트를 만들어 응답한다.
+
+#ifndef SERVER_METRICS_H
+#define SERVER_METRICS_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// 구간 i의 상한 = 2^i us (i = 0 ~ METRICS_BUCKETS - 2, 약 1초까지), 마지막 구간 = 그 이상
+#define METRICS_BUCKETS 22
+
+typedef struct LatencyHistogram {
+    atomic_ulong count;
+    atomic_ulong sum_us;
+    atomic_ulong max_us;
+    atomic_ulong buckets[METRICS_BUCKETS];  // 구간별 개수 (누적 아님)
+} LatencyHistogram;
+
+static inline uint64_t metrics_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// start_ns(metrics_now_ns 값)부터 지금까지의 시간 기록
+void latency_record_since(LatencyHistogram *h, uint64_t start_ns);
+
+// 분위수 추정 (해당 구간 상한, 최댓값을 넘지 않음), 기록이 없으면 0
+unsigned long latency_percentile_us(const LatencyHistogram *h, double q);
+
+// Prometheus 텍스트 작성 도우미: buf[*len]부터 이어 쓰고 *len 갱신 (공간이 모자라면 잘라냄)
+void metrics_printf(char *buf, size_t size, size_t *len, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+// name_bucket{labels,le=...} / name_sum / name_count (초 단위), labels는 "" 또는 `cmd="LED_ON"` 형식
+void metrics_write_histogram(char *buf, size_t size, size_t *len, const char *name, const char *labels,
+                             const LatencyHistogram *h);
+
+// 지표 본문 작성 콜백 (내보내기 스레드에서 호출), 반환값: 작성한 길이
+typedef size_t (*metrics_render_fn)(char *buf, size_t size);
+
+// 127.0.0.1:port에서 지표 요청을 받는 스레드 시작 (실패 시 -1)
+int metrics_exporter_start(int port, metrics_render_fn render);
+
+// 이전 서버 프로세스에게서 넘겨받은 리스닝 fd로 시작 (서버 교체 시 포트가 닫히는 구간 없음)
+int metrics_exporter_adopt(int fd, metrics_render_fn render);
+
+// 응답 중인 리스닝 fd (시작 전이면 -1)
+int metrics_exporter_fd(void);
+
+#endif // SERVER_METRICS_H
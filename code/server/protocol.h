@@ -0,0 +1,116 @@
+// 바이너리 명령 프로토콜 정의 (서버와 기계 제어용 클라이언트가 공유)
+// 텍스트 연결에서 PROTO_BINARY_HELLO를 보내고 PROTO_BINARY_ACK 줄을 받은 뒤부터
+// 같은 연결의 모든 데이터는 고정 8바이트 프레임으로 주고받는다.
+//
+// 요청 프레임: [opcode:1][flags:1][request_id:2][arg:4]
+// 응답 프레임: [opcode:1][status:1][request_id:2][value:4]   (opcode는 요청 값을 그대로 돌려줌)
+// 이벤트 프레임: [PROTO_OP_EVENT:1][event:1][0:2][value:4]   (브로드캐스트)
+// 다중 바이트 필드는 네트워크 바이트 순서(빅 엔디언)
+
+#ifndef SERVER_PROTOCOL_H
+#define SERVER_PROTOCOL_H
+
+#include <stdint.h>
+
+#define PROTO_BINARY_HELLO "PROTOCOL BINARY\n"
+#define PROTO_BINARY_ACK   "PROTOCOL BINARY OK\n"
+#define PROTO_FRAME_SIZE   8
+
+#define PROTO_FLAG_HAS_ARG 0x01  // 요청 flags: arg 필드가 유효함
+
+// 명령 코드 (텍스트 동사와 1:1 대응)
+typedef enum ProtoOpcode {
+    PROTO_OP_NONE              = 0x00,  // 텍스트 전용 명령 (바이너리 코드 없음)
+    PROTO_OP_LED_ON            = 0x01,
+    PROTO_OP_LED_OFF           = 0x02,
+    PROTO_OP_LED_BRIGHTNESS    = 0x03,
+    PROTO_OP_BUZZER_ON         = 0x04,
+    PROTO_OP_BUZZER_OFF        = 0x05,
+    PROTO_OP_SEGMENT_DISPLAY   = 0x06,
+    PROTO_OP_SEGMENT_COUNTDOWN = 0x07,
+    PROTO_OP_SEGMENT_STOP      = 0x08,
+    PROTO_OP_QUIZ_START        = 0x09,
+    PROTO_OP_QUIZ_ANSWER       = 0x0A,
+    PROTO_OP_SENSOR_ON         = 0x0B,
+    PROTO_OP_SENSOR_OFF        = 0x0C,
+    PROTO_OP_BUZZER_PATTERN    = 0x0D,  // value: 작업 번호 (종료 시 PROTO_EVT_BUZZER_DONE)
+    PROTO_OP_BUZZER_STATS      = 0x0E,  // value: 최대 음 시작 지터 (us)
+    PROTO_OP_STATUS            = 0x0F,  // value: 장치 상태 (아래 PROTO_STATUS_* 비트 배치)
+    PROTO_OP_SENSOR_READ       = 0x10,  // value: 최신 센서 값 (샘플 없으면 PROTO_ST_NOT_RUNNING)
+    PROTO_OP_SENSOR_FILTER     = 0x11,  // 조회 전용, value: 필터가 거른 샘플/후보 수
+    PROTO_OP_SUBSCRIBE         = 0x12,  // arg: 추가할 PROTO_TOPIC_* 마스크, value: 변경 후 구독 마스크
+    PROTO_OP_UNSUBSCRIBE       = 0x13,  // arg: 해제할 PROTO_TOPIC_* 마스크, value: 변경 후 구독 마스크
+    PROTO_OP_SENSOR_HISTORY    = 0x14,  // arg: since_seq, value: 그 이후 기록된 센서 변화 수
+    PROTO_OP_BATCH             = 0x15,  // arg: 바로 뒤따르는 명령 프레임 수, 응답 한 프레임으로 묶어 실행
+                                        // (status: 모두 성공하면 OK, 아니면 멈춘 명령의 상태, value: 성공한 명령 수)
+    PROTO_OP_STATS             = 0x16,  // value: 전체 명령 처리 시간 p99 (us)
+    PROTO_OP_RELOAD            = 0x17,  // 장치 라이브러리 재적재, value: 재적재 횟수 (진행 중이면 PROTO_ST_BUSY)
+    PROTO_OP_EVENT             = 0xFF   // 서버 → 클라이언트 브로드캐스트
+} ProtoOpcode;
+
+// 응답 상태 코드 (텍스트 응답 문구에 대응)
+typedef enum ProtoStatus {
+    PROTO_ST_OK          = 0,  // 성공 (QUIZ_ANSWER는 value 1 = 정답, 0 = 오답)
+    PROTO_ST_BAD_ARG     = 1,  // 인자 범위 오류
+    PROTO_ST_BUSY        = 2,  // 이미 실행 중 / 이미 켜짐
+    PROTO_ST_NOT_RUNNING = 3,  // 실행 중이 아님 / 이미 꺼짐
+    PROTO_ST_FAILED      = 4,  // 내부 오류 (스레드 생성/메모리 할당 실패 등)
+    PROTO_ST_UNAVAILABLE = 5,  // 장치 라이브러리가 기능을 제공하지 않음
+    PROTO_ST_UNKNOWN     = 6,  // 알 수 없는 명령
+    PROTO_ST_INVALID     = 7   // 형식 오류
+} ProtoStatus;
+
+// 이벤트 코드 (텍스트 브로드캐스트 문구에 대응)
+typedef enum ProtoEvent {
+    PROTO_EVT_CDS                = 1,  // value: 0 = 빛 감지(LED OFF), 1 = 빛 없음(LED ON)
+    PROTO_EVT_COUNTDOWN_COMPLETE = 2,
+    PROTO_EVT_COUNTDOWN_STOPPED  = 3,
+    PROTO_EVT_QUIZ_TIMEOVER      = 4,
+    PROTO_EVT_SERVER_SHUTDOWN    = 5,
+    PROTO_EVT_BUZZER_DONE        = 6   // value: BUZZER_PATTERN 작업 번호
+} ProtoEvent;
+
+// 이벤트 구독 주제 (연결마다 비트 마스크로 저장, 연결 직후에는 모두 구독)
+// PROTO_EVT_SERVER_SHUTDOWN은 주제와 무관하게 항상 전달
+#define PROTO_TOPIC_SENSOR     0x01  // PROTO_EVT_CDS
+#define PROTO_TOPIC_COUNTDOWN  0x02  // PROTO_EVT_COUNTDOWN_COMPLETE / _STOPPED
+#define PROTO_TOPIC_QUIZ       0x04  // PROTO_EVT_QUIZ_TIMEOVER
+#define PROTO_TOPIC_BUZZER     0x08  // PROTO_EVT_BUZZER_DONE
+#define PROTO_TOPIC_ALL        0x0F
+#define PROTO_TOPIC_COUNT      4
+
+// PROTO_OP_STATUS 응답 value 비트 배치
+// [31:16] 부저 주파수 (0 = 무음) | [11] 퀴즈 | [10] 카운트다운 | [9] 센서 모니터링 | [7:4] 세그먼트 | [3:0] LED 밝기
+#define PROTO_STATUS_UNKNOWN        0x0F    // LED/세그먼트 필드: 알 수 없음
+#define PROTO_STATUS_SEGMENT_SHIFT  4
+#define PROTO_STATUS_SENSOR_ON      0x200
+#define PROTO_STATUS_COUNTDOWN      0x400
+#define PROTO_STATUS_QUIZ           0x800
+#define PROTO_STATUS_BUZZER_SHIFT   16
+
+// 프레임 인코딩/디코딩
+static inline void proto_pack(uint8_t *frame, uint8_t op, uint8_t code, uint16_t id, int32_t value)
+{
+    uint32_t v = (uint32_t)value;
+    frame[0] = op;
+    frame[1] = code;
+    frame[2] = (uint8_t)(id >> 8);
+    frame[3] = (uint8_t)id;
+    frame[4] = (uint8_t)(v >> 24);
+    frame[5] = (uint8_t)(v >> 16);
+    frame[6] = (uint8_t)(v >> 8);
+    frame[7] = (uint8_t)v;
+}
+
+static inline uint16_t proto_frame_id(const uint8_t *frame)
+{
+    return (uint16_t)((frame[2] << 8) | frame[3]);
+}
+
+static inline int32_t proto_frame_value(const uint8_t *frame)
+{
+    return (int32_t)(((uint32_t)frame[4] << 24) | ((uint32_t)frame[5] << 16) |
+                     ((uint32_t)frame[6] << 8) | (uint32_t)frame[7]);
+}
+
+#endif // SERVER_PROTOCOL_H
@@ -0,0 +1,327 @@
+// CDS 센서 샘플 공유 (seqlock), 이력 및 필터
+// - 기록자: 순서 번호를 홀수로 만든 뒤 필드를 쓰고 다시 짝수로 만든다
+// - 읽기: 짝수 번호를 확인하고 필드를 복사한 뒤 번호가 그대로인지 확인, 달라졌으면 다시 읽는다
+// - 필드는 relaxed 원자 접근으로 읽고 써서 경합 중에도 데이터 경쟁이 없도록 한다
+
+#include <stdatomic.h>
+#include <time.h>
+
+#include "sensor.h"
+
+static atomic_uint snap_seq = 0;  // 홀수 = 게시 중
+static atomic_int snap_value = -1;
+static atomic_ullong snap_mono_ns = 0;
+static atomic_ullong snap_time_ms = 0;
+static atomic_ullong snap_samples = 0;
+static atomic_ullong snap_changes = 0;
+
+static void history_record(int value, int changed, uint64_t mono_ns, uint64_t time_ms, uint64_t seq);
+
+int sensor_publish(int value)
+{
+    struct timespec mono, real;
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME, &real);
+    uint64_t mono_ns = (uint64_t)mono.tv_sec * 1000000000ULL + (uint64_t)mono.tv_nsec;
+    uint64_t time_ms = (uint64_t)real.tv_sec * 1000ULL + (uint64_t)real.tv_nsec / 1000000ULL;
+
+    int previous = atomic_load_explicit(&snap_value, memory_order_relaxed);
+    int changed = previous != value;
+
+    unsigned seq = atomic_load_explicit(&snap_seq, memory_order_relaxed);
+    atomic_store_explicit(&snap_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&snap_value, value, memory_order_relaxed);
+    atomic_store_explicit(&snap_mono_ns, mono_ns, memory_order_relaxed);
+    atomic_store_explicit(&snap_time_ms, time_ms, memory_order_relaxed);
+    uint64_t sample_seq = atomic_fetch_add_explicit(&snap_samples, 1, memory_order_relaxed) + 1;
+    if (changed && previous >= 0) {
+        atomic_fetch_add_explicit(&snap_changes, 1, memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&snap_seq, seq + 2, memory_order_release);
+
+    history_record(value, changed, mono_ns, time_ms, sample_seq);
+    return changed;
+}
+
+int sensor_read(SensorSample *out)
+{
+    unsigned begin, end;
+    do {
+        begin = atomic_load_explicit(&snap_seq, memory_order_acquire);
+        if (begin & 1) {
+            continue;  // 게시 중: 기록자는 몇 번의 저장만 하므로 바로 다시 시도
+        }
+        out->value = atomic_load_explicit(&snap_value, memory_order_relaxed);
+        out->mono_ns = atomic_load_explicit(&snap_mono_ns, memory_order_relaxed);
+        out->time_ms = atomic_load_explicit(&snap_time_ms, memory_order_relaxed);
+        out->seq = atomic_load_explicit(&snap_samples, memory_order_relaxed);
+        out->changes = atomic_load_explicit(&snap_changes, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        end = atomic_load_explicit(&snap_seq, memory_order_relaxed);
+    } while ((begin & 1) || begin != end);
+
+    return out->value < 0 ? -1 : 0;
+}
+
+// ===== 이력 =====
+// 변화 이력: 값이 바뀐 샘플(과 모니터링 재개 후 첫 샘플)만 고정 크기 링에 기록 (가장 오래된 것부터 덮어씀)
+// 분 단위 집계: 샘플 사이 구간을 직전 값으로 간주하여 벽시계 분 경계로 나눠 관측/켜짐 시간을 누적
+//              (구간 길이는 단조 시계 차이로 계산하여 시계 조정에 흔들리지 않음)
+
+static SensorHistoryEntry history[SENSOR_HISTORY_LEN];
+static uint64_t history_total = 0;   // 지금까지 기록한 항목 수 (링 위치 = total % LEN)
+
+static SensorMinute minutes[SENSOR_MINUTES_LEN];
+static int history_open = 0;         // 직전 샘플 이후 구간을 집계 중
+static int open_value = 0;
+static uint64_t open_mono_ns = 0;
+static uint64_t open_time_ms = 0;
+
+static SensorMinute *minute_bucket(uint64_t minute)
+{
+    SensorMinute *bucket = &minutes[minute % SENSOR_MINUTES_LEN];
+    if (bucket->minute != minute) {
+        bucket->minute = minute;
+        bucket->on_ms = 0;
+        bucket->observed_ms = 0;
+        bucket->transitions = 0;
+    }
+    return bucket;
+}
+
+// [open_time_ms, open_time_ms + length_ms) 구간을 분 경계로 나눠 누적
+static void account_interval(int value, uint64_t start_ms, uint64_t length_ms)
+{
+    while (length_ms > 0) {
+        uint64_t minute = start_ms / 60000ULL;
+        uint64_t chunk = (minute + 1) * 60000ULL - start_ms;
+        if (chunk > length_ms) chunk = length_ms;
+
+        SensorMinute *bucket = minute_bucket(minute);
+        bucket->observed_ms += (uint32_t)chunk;
+        if (value) bucket->on_ms += (uint32_t)chunk;
+
+        start_ms += chunk;
+        length_ms -= chunk;
+    }
+}
+
+static void history_record(int value, int changed, uint64_t mono_ns, uint64_t time_ms, uint64_t seq)
+{
+    if (history_open) {
+        uint64_t length_ms = (mono_ns - open_mono_ns) / 1000000ULL;
+        if (length_ms > (uint64_t)SENSOR_MINUTES_LEN * 60000ULL) {
+            length_ms = (uint64_t)SENSOR_MINUTES_LEN * 60000ULL;  // 집계 창보다 긴 구간은 잘라냄
+        }
+        account_interval(open_value, open_time_ms, length_ms);
+        open_time_ms += length_ms;
+        if (changed) {
+            minute_bucket(time_ms / 60000ULL)->transitions++;
+        }
+    }
+
+    if (changed || !history_open) {
+        SensorHistoryEntry *entry = &history[history_total % SENSOR_HISTORY_LEN];
+        entry->seq = seq;
+        entry->time_ms = time_ms;
+        entry->value = value;
+        history_total++;
+    }
+
+    if (!history_open) {
+        open_time_ms = time_ms;
+    }
+    history_open = 1;
+    open_value = value;
+    open_mono_ns = mono_ns;
+}
+
+void sensor_history_pause(void)
+{
+    history_open = 0;
+}
+
+int sensor_history_since(uint64_t since_seq, SensorHistoryEntry *out, int max, int *remaining)
+{
+    uint64_t first = history_total > SENSOR_HISTORY_LEN ? history_total - SENSOR_HISTORY_LEN : 0;
+
+    // 링은 seq 오름차순이므로 이진 탐색으로 since_seq 다음 항목 위치를 찾음
+    uint64_t lo = first, hi = history_total;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (history[mid % SENSOR_HISTORY_LEN].seq <= since_seq) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    int count = 0;
+    for (uint64_t i = lo; i < history_total && count < max; ++i) {
+        out[count++] = history[i % SENSOR_HISTORY_LEN];
+    }
+    if (remaining) {
+        *remaining = (int)(history_total - lo - (uint64_t)count);
+    }
+    return count;
+}
+
+int sensor_history_minutes(SensorMinute *out, int max)
+{
+    if (!history_open && history_total == 0) return 0;
+
+    // 가장 최근 분부터 거꾸로 (비어 있거나 창 밖의 분은 건너뜀)
+    uint64_t newest = 0;
+    for (int i = 0; i < SENSOR_MINUTES_LEN; ++i) {
+        if (minutes[i].observed_ms > 0 && minutes[i].minute > newest) newest = minutes[i].minute;
+    }
+
+    int count = 0;
+    for (int back = 0; back < SENSOR_MINUTES_LEN && count < max; ++back) {
+        if ((uint64_t)back > newest) break;
+        const SensorMinute *bucket = &minutes[(newest - (uint64_t)back) % SENSOR_MINUTES_LEN];
+        if (bucket->minute == newest - (uint64_t)back && bucket->observed_ms > 0) {
+            out[count++] = *bucket;
+        }
+    }
+    return count;
+}
+
+// ===== 필터 =====
+// 다수결로 순간 튀는 샘플을 거르고, 다수결 결과(후보)가 debounce_ms 동안 유지되면 확정하되
+// 직전 확정 후 hold_ms가 지나지 않았으면 그때까지 미룬다. 보류 중에는 재판정 시점을 알려
+// 엣지 알림 모드에서도 새 엣지 없이 판정이 끝나도록 한다.
+
+static SensorFilterConfig filter_config = SENSOR_FILTER_DEFAULT;
+static SensorFilterStats filter_stats;
+
+static int window[SENSOR_VOTE_MAX];
+static int window_len = 0;
+static int window_pos = 0;
+
+static int stable = -1;           // 확정 값
+static int candidate = -1;        // 보류 중인 후보 (-1 = 없음)
+static int candidate_deferred = 0;
+static uint64_t candidate_since_ns = 0;
+static uint64_t last_accept_ns = 0;
+
+int sensor_filter_valid(const SensorFilterConfig *config)
+{
+    return config->debounce_ms >= 0 && config->debounce_ms <= 60000 &&
+           config->vote_n >= 1 && config->vote_n <= SENSOR_VOTE_MAX &&
+           config->hold_ms >= 0 && config->hold_ms <= 60000;
+}
+
+int sensor_filter_configure(const SensorFilterConfig *config)
+{
+    if (!sensor_filter_valid(config)) {
+        return -1;
+    }
+    filter_config = *config;
+    // 다수결 창 길이가 바뀔 수 있으므로 창과 보류 후보만 비우고 확정 값은 유지 (불필요한 재알림 방지)
+    window_len = 0;
+    window_pos = 0;
+    candidate = -1;
+    return 0;
+}
+
+void sensor_filter_get_config(SensorFilterConfig *out)
+{
+    *out = filter_config;
+}
+
+void sensor_filter_reset(void)
+{
+    window_len = 0;
+    window_pos = 0;
+    stable = -1;
+    candidate = -1;
+    candidate_deferred = 0;
+}
+
+void sensor_filter_seed(int value)
+{
+    sensor_filter_reset();
+    stable = value;
+    last_accept_ns = 0;  // 유지 시간은 새 서버에서 처음 바뀔 때부터 적용
+}
+
+static int window_vote(int raw)
+{
+    window[window_pos] = raw;
+    window_pos = (window_pos + 1) % filter_config.vote_n;
+    if (window_len < filter_config.vote_n) window_len++;
+
+    int ones = 0;
+    for (int i = 0; i < window_len; ++i) {
+        ones += window[i] != 0;
+    }
+    if (ones * 2 > window_len) return 1;
+    if (ones * 2 < window_len) return 0;
+    return stable >= 0 ? stable : raw;  // 동수: 기존 값 유지
+}
+
+int sensor_filter_push(int raw, uint64_t now_ns, long *recheck_ms)
+{
+    *recheck_ms = -1;
+    filter_stats.samples++;
+
+    int vote = window_vote(raw);
+    if (stable < 0) {
+        stable = vote;
+        last_accept_ns = now_ns;
+        filter_stats.accepted++;
+        return stable;
+    }
+
+    if (vote == stable) {
+        if (raw != stable) {
+            filter_stats.vote_suppressed++;
+        }
+        if (candidate >= 0) {
+            filter_stats.debounce_suppressed++;
+            candidate = -1;
+        }
+        return -1;
+    }
+
+    if (candidate != vote) {
+        candidate = vote;
+        candidate_since_ns = now_ns;
+        candidate_deferred = 0;
+    }
+
+    uint64_t debounce_due = candidate_since_ns + (uint64_t)filter_config.debounce_ms * 1000000ULL;
+    if (now_ns < debounce_due) {
+        *recheck_ms = (long)((debounce_due - now_ns + 999999ULL) / 1000000ULL);
+        return -1;
+    }
+    uint64_t hold_due = last_accept_ns + (uint64_t)filter_config.hold_ms * 1000000ULL;
+    if (now_ns < hold_due) {
+        if (!candidate_deferred) {
+            filter_stats.hold_deferred++;
+            candidate_deferred = 1;
+        }
+        *recheck_ms = (long)((hold_due - now_ns + 999999ULL) / 1000000ULL);
+        return -1;
+    }
+
+    stable = candidate;
+    candidate = -1;
+    last_accept_ns = now_ns;
+    filter_stats.accepted++;
+    return stable;
+}
+
+int sensor_filter_stable(void)
+{
+    return stable;
+}
+
+void sensor_filter_get_stats(SensorFilterStats *out)
+{
+    *out = filter_stats;
+}
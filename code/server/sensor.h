@@ -0,0 +1,100 @@
+// CDS 센서 샘플 공유, 이력 및 필터 헤더
+// 모니터링(I/O 루프의 타이머 작업)이 유일한 기록자로 최신 샘플을 게시하고,
+// 어느 스레드든 잠금 없이 일관된 샘플을 읽는다 (seqlock: 읽기 중 게시가 끼면 다시 읽음).
+// 원시 샘플은 필터(다수결 → 디바운스 → 최소 유지 시간)를 거쳐 확정된 변화만 LED 제어/브로드캐스트로 이어진다.
+
+#ifndef SERVER_SENSOR_H
+#define SERVER_SENSOR_H
+
+#include <stdint.h>
+
+typedef struct SensorSample {
+    int value;             // 센서 값 (0: 빛 감지, 1: 빛 없음), 아직 읽지 않았으면 -1
+    uint64_t mono_ns;      // 읽은 시각 (CLOCK_MONOTONIC)
+    uint64_t time_ms;      // 읽은 시각 (CLOCK_REALTIME, 밀리초)
+    uint64_t seq;          // 샘플 번호 (게시할 때마다 1 증가)
+    uint64_t changes;      // 값이 바뀐 횟수
+} SensorSample;
+
+// 새 샘플 게시 (단일 기록자 전용), 반환값: 직전 게시 값과 다르면 1
+int sensor_publish(int value);
+
+// 최신 샘플 복사 (여러 읽기 스레드가 동시에 호출 가능, 블로킹 없음), 샘플이 없으면 -1
+int sensor_read(SensorSample *out);
+
+// ===== 이력 (I/O 루프 스레드 전용, sensor_publish가 기록) =====
+
+#define SENSOR_HISTORY_LEN 1024  // 변화 이력 링 크기
+#define SENSOR_MINUTES_LEN 60    // 분 단위 집계 보관 수 (최근 1시간)
+
+typedef struct SensorHistoryEntry {
+    uint64_t seq;      // 샘플 번호 (SensorSample.seq와 같은 번호 체계)
+    uint64_t time_ms;  // 벽시계 시각 (밀리초)
+    int value;
+} SensorHistoryEntry;
+
+typedef struct SensorMinute {
+    uint64_t minute;       // 벽시계 기준 분 번호 (epoch 밀리초 / 60000)
+    uint32_t on_ms;        // 값이 1(빛 없음)이었던 시간
+    uint32_t observed_ms;  // 모니터링으로 관측한 시간
+    uint32_t transitions;  // 값이 바뀐 횟수
+} SensorMinute;
+
+// 모니터링 중지 시 호출: 다음 샘플까지의 공백은 관측 시간에 넣지 않음
+void sensor_history_pause(void);
+
+// seq가 since_seq보다 큰 변화 이력을 오래된 순으로 최대 max개 복사
+// 반환값: 복사한 수, *remaining: 아직 남은 수 (다음 조회는 마지막 항목의 seq로)
+int sensor_history_since(uint64_t since_seq, SensorHistoryEntry *out, int max, int *remaining);
+
+// 분 단위 집계를 최근 분부터 최대 max개 복사, 반환값: 복사한 수
+int sensor_history_minutes(SensorMinute *out, int max);
+
+// ===== 필터 (I/O 루프 스레드 전용) =====
+
+#define SENSOR_VOTE_MAX 15  // 다수결 창 최대 샘플 수
+
+typedef struct SensorFilterConfig {
+    int debounce_ms;  // 새 값이 이 시간 동안 유지되어야 확정 (0 = 즉시)
+    int vote_n;       // 최근 N개 샘플 다수결 (1 = 사용 안 함, 홀수 권장)
+    int hold_ms;      // 확정 후 이 시간 동안은 다음 변화를 미룸 (0 = 사용 안 함)
+} SensorFilterConfig;
+
+typedef struct SensorFilterStats {
+    unsigned long samples;              // 입력된 원시 샘플 수
+    unsigned long accepted;             // 확정된 변화 수 (첫 값 포함)
+    unsigned long vote_suppressed;      // 원시 값은 바뀌었지만 다수결이 기존 값을 유지한 샘플 수
+    unsigned long debounce_suppressed;  // 디바운스 시간 안에 되돌아가 버려진 후보 수
+    unsigned long hold_deferred;        // 최소 유지 시간 때문에 확정이 미뤄진 후보 수
+} SensorFilterStats;
+
+#define SENSOR_FILTER_DEFAULT { 20, 1, 0 }
+
+// 설정 범위 검사 (적용하지 않음), 범위 안이면 1
+int sensor_filter_valid(const SensorFilterConfig *config);
+
+// 설정 검사 후 적용 (범위 밖이면 -1), 다수결 창과 보류 후보는 비우고 확정 값은 유지
+int sensor_filter_configure(const SensorFilterConfig *config);
+void sensor_filter_get_config(SensorFilterConfig *out);
+
+// 모니터링 시작 시 호출: 다음 첫 샘플은 바로 확정
+void sensor_filter_reset(void);
+
+// 서버 교체 후 모니터링 재개 시 호출: 이전 서버의 확정 값에서 이어서 판정 (같은 값이면 다시 알리지 않음)
+void sensor_filter_seed(int value);
+
+// 원시 샘플 입력, 반환값: 새로 확정된 값 (변화 없으면 -1)
+// *recheck_ms: 보류 중인 후보를 다시 판정해야 하는 시점까지 남은 시간 (보류 없음 = -1)
+int sensor_filter_push(int raw, uint64_t now_ns, long *recheck_ms);
+
+// 현재 확정 값 (아직 없으면 -1)
+int sensor_filter_stable(void);
+
+void sensor_filter_get_stats(SensorFilterStats *out);
+
+static inline uint64_t sensor_age_ms(const SensorSample *sample, uint64_t now_mono_ns)
+{
+    return now_mono_ns > sample->mono_ns ? (now_mono_ns - sample->mono_ns) / 1000000ULL : 0;
+}
+
+#endif // SERVER_SENSOR_H
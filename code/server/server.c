@@ -1,9 +1,11 @@
+#define _GNU_SOURCE  // accept4, memfd_create
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <signal.h>
 #include <errno.h>
@@ -11,21 +13,50 @@
 #include <pthread.h>
 #include <time.h>
 #include <libgen.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "logger.h"
+#include "protocol.h"
+#include "actuator.h"
+#include "timer.h"
+#include "sensor.h"
+#include "journal.h"
+#include "metrics.h"
+#include "handoff.h"
+#include "cmdqueue.h"
+#include "uring.h"
 
 #define PORT 8080
 #define BUFFER_SIZE 1024
-#define CDS_CHECK_INTERVAL 100  // CDS 센서 체크 간격 (밀리초)
-#define MAX_CLIENTS 32          // 최대 클라이언트 수
+#define MAX_EVENTS 64           // epoll_wait 한 번에 처리할 최대 이벤트 수
+#define OUT_QUEUE_LEN 64        // 클라이언트별 송신 대기 메시지 수 (2의 거듭제곱)
+#define OUT_IOV_MAX 16          // writev 한 번에 묶어 보낼 메시지 수
+#define CDS_CHECK_INTERVAL 100  // CDS 센서 체크 간격 (밀리초, 엣지 알림 미지원 라이브러리용 폴링)
+#define CDS_EDGE_RESYNC_MS 5000 // 엣지 대기 중 놓친 엣지 보정을 위한 재확인 주기 (밀리초)
+#define BUZZER_DEFAULT_FREQ 440 // BUZZER_ON 연속음 주파수 (wiringBuzzer.c의 buzzer_on과 동일)
+#define MAX_CLIENTS 32          // 기본 최대 클라이언트 수 (환경 변수 DEVICE_SERVER_MAX_CLIENTS로 변경)
+#define CLIENT_SLOT_BITS 16     // 클라이언트 핸들 중 슬롯 번호 비트 수 (나머지는 세대)
+#define SNAPSHOT_STACK 64       // 이 수 이하의 클라이언트 스냅샷은 스택 배열 사용
+#define BATCH_MAX_OPS 16        // BATCH 한 번에 실행할 최대 명령 수
+#define METRICS_PORT 9180       // 지표 내보내기 포트 (127.0.0.1 전용, 환경 변수 DEVICE_SERVER_METRICS_PORT로 변경, 0 = 끔)
+#define REACTOR_MAX 16          // 리액터 스레드 최대 수 (환경 변수 DEVICE_SERVER_REACTORS, 기본 = 온라인 CPU 수)
+#define LISTEN_BACKLOG 128      // 리스닝 백로그 기본값 (환경 변수 DEVICE_SERVER_BACKLOG, 커널 somaxconn 이하로 제한됨)
+#define OWNER_DRAIN_MAX 256     // 장치 소유 스레드가 깨어날 때마다 실행할 최대 명령 수 (타이머/센서가 밀리지 않도록)
+#define URING_BUF_COUNT 256     // io_uring 백엔드 리액터별 수신 제공 버퍼 수 (각 BUFFER_SIZE 바이트)
 
 // 함수 선언 (forward declaration)
 static char* get_exe_directory(void);
 static const char* get_pid_file_path(void);
-static void *cds_monitor_thread_func(void *arg);
-static void *segment_countdown_thread_func(void *arg);
-static void *quiz_thread_func(void *arg);
-static void add_client_to_list(int socket_fd);
-static void remove_client_from_list(int socket_fd);
-static void broadcast_to_clients(const char *message);
+static void broadcast_to_clients(const char *message, ProtoEvent event);
 
 // 로그 파일 경로는 실행 파일 디렉토리의 부모 디렉토리를 기준으로 동적으로 생성
 static const char* get_log_file_path(void) {
@@ -53,47 +84,30 @@ static const char* get_log_file_path(void) {
     return log_path;
 }
 
-// 로그 기록용 보조 함수 (데몬은 화면 출력이 안 되므로 필수)
-void log_event(const char *msg) {
-    const char *log_file = get_log_file_path();
-    FILE *fp = fopen(log_file, "a");
-    if (fp) {
-        time_t now = time(NULL);
-        struct tm *t = localtime(&now);
-        fprintf(fp, "[%02d:%02d:%02d] %s\n", t->tm_hour, t->tm_min, t->tm_sec, msg);
-        fclose(fp);
-    }
-}
 
+// 시간 기반 장치 동작은 스레드 대신 I/O 루프의 타이머 작업으로 실행 (timer.c)
+// 명령 핸들러와 타이머 콜백이 모두 I/O 루프 스레드에서 실행되므로 아래 상태에는 잠금이 필요 없음
+static void cds_monitor_tick(void *arg);
+static void segment_countdown_tick(void *arg);
+static void quiz_tick(void *arg);
 
-int server_socket = -1;
-volatile int cds_monitor_running = 0;  // CDS 모니터링 스레드 실행 플래그
-volatile int cds_thread_created = 0;   // CDS 모니터링 스레드 생성 여부
-pthread_t cds_monitor_thread;         // CDS 모니터링 스레드 ID
-pthread_mutex_t cds_monitor_mutex = PTHREAD_MUTEX_INITIALIZER;  // CDS 모니터링 제어 뮤텍스
+// CDS 센서 모니터링 상태
+static int cds_monitor_running = 0;   // 모니터링 실행 여부
+static int cds_edge_fd = -1;          // 엣지 알림 fd (epoll 등록, -1이면 폴링 모드)
+static TimerTask cds_monitor_task = TIMER_TASK_INIT(cds_monitor_tick, NULL);  // 폴링 또는 엣지 재확인
 
-volatile int segment_countdown_running = 0;  // 7SEG 카운트다운 스레드 실행 플래그
-volatile int segment_thread_created = 0;     // 7SEG 카운트다운 스레드 생성 여부
-pthread_t segment_countdown_thread;         // 7SEG 카운트다운 스레드 ID
-pthread_mutex_t segment_countdown_mutex = PTHREAD_MUTEX_INITIALIZER;  // 7SEG 카운트다운 제어 뮤텍스
+// 7SEG 카운트다운 상태 (작업이 예약되어 있으면 진행 중)
+static int segment_countdown_value = 0;  // 다음 틱에 표시할 숫자
+static TimerTask segment_countdown_task = TIMER_TASK_INIT(segment_countdown_tick, NULL);
 
 // 퀴즈 기능 상태
-volatile int quiz_running = 0;   // 퀴즈 진행 중 여부
-volatile int quiz_correct = 0;   // 정답 여부
-pthread_t quiz_thread;           // 퀴즈 카운트다운 스레드
-pthread_mutex_t quiz_mutex = PTHREAD_MUTEX_INITIALIZER;  // 퀴즈 상태 보호
-
-// 연결된 클라이언트 목록 관리
-typedef struct ClientList {
-    int socket_fd;
-    struct ClientList *next;
-} ClientList;
-
-ClientList *client_list_head = NULL;  // 클라이언트 목록 헤드
-pthread_mutex_t client_list_mutex = PTHREAD_MUTEX_INITIALIZER;  // 클라이언트 목록 접근 보호
+static int quiz_running = 0;     // 퀴즈 진행 중 여부
+static int quiz_remaining = 0;   // 다음 틱에 표시할 남은 초
+static TimerTask quiz_task = TIMER_TASK_INIT(quiz_tick, NULL);
 
 // ===== 통합 장치 라이브러리용 함수 포인터 타입 정의 =====
 typedef int (*device_init_all_t)(void);
+typedef int (*device_release_all_t)(void);
 
 typedef int (*led_init_t)(void);
 typedef int (*led_on_t)(void);
@@ -107,6 +121,7 @@ typedef int (*buzzer_warning_t)(void);
 typedef int (*buzzer_emergency_t)(void);
 typedef int (*buzzer_success_t)(void);
 typedef int (*buzzer_fail_t)(void);
+typedef int (*buzzer_tone_t)(int);
 
 typedef int (*segment_init_t)(void);
 typedef int (*segment_display_t)(int);
@@ -114,11 +129,14 @@ typedef int (*segment_countdown_t)(int);
 
 typedef int (*sensor_init_t)(void);
 typedef int (*sensor_get_value_t)(int *);
+typedef int (*sensor_edge_fd_t)(void);
 
 typedef struct DeviceLibs {
     void *device_handle;  // 통합 라이브러리 핸들
+    int image_fd;         // 재적재로 연 라이브러리 사본(memfd), 핸들이 살아 있는 동안 유지 (시작 시 로드는 -1)
 
     device_init_all_t     device_init_all;
+    device_release_all_t  device_release_all;  // 선택: 없으면 재적재 후에도 이전 라이브러리를 언로드하지 않음
 
     led_init_t            led_init;
     led_on_t              led_on;
@@ -132,6 +150,7 @@ typedef struct DeviceLibs {
     buzzer_emergency_t  buzzer_emergency;
     buzzer_success_t      buzzer_success;
     buzzer_fail_t         buzzer_fail;
+    buzzer_tone_t         buzzer_tone;       // 선택: 없으면 buzzer_on/off로 대체
 
     segment_init_t        segment_init;
     segment_display_t     segment_display;
@@ -139,22 +158,236 @@ typedef struct DeviceLibs {
 
     sensor_init_t         sensor_init;
     sensor_get_value_t    sensor_get_value;
+    sensor_edge_fd_t      sensor_edge_fd;    // 선택: 없으면 폴링으로 동작
 } DeviceLibs;
 
-DeviceLibs g_libs = {0};
+// 현재 장치 라이브러리 표: RELOAD 시 새 표를 만들어 포인터만 교체
+// I/O 루프가 교체하고, 액추에이터 스레드(buzzer_tone_write)도 읽음 (이전 표는 device_libs_reclaim에서 해제)
+static _Atomic(DeviceLibs *) active_libs = NULL;
+
+static DeviceLibs *device_libs(void) {
+    return atomic_load(&active_libs);
+}
+
+// 장치 상태 캐시: 마지막으로 하드웨어에 쓴 값 (DEVICE_STATE_UNKNOWN이면 다음 쓰기는 반드시 수행)
+// LED/세그먼트는 I/O 루프 스레드에서만, 부저는 액추에이터 스레드에서만 쓰므로 항목별 쓰기 경합 없음
+#define DEVICE_STATE_UNKNOWN (-1)
+#define LED_LEVEL_MAX 3  // LED_ON은 밝기 3과 같은 PWM 출력
+
+typedef struct DeviceState {
+    int led_level;            // 0 = 꺼짐, 1~3 = 밝기
+    int segment_digit;        // 표시 중인 숫자 (0~9)
+    atomic_int buzzer_freq;   // 현재 주파수 (0 = 무음), STATUS는 I/O 루프에서 읽음
+    atomic_ulong writes;      // 실제 하드웨어 쓰기 수
+    atomic_ulong skipped;     // 같은 값이라 생략한 쓰기 수
+} DeviceState;
+
+static DeviceState device_state = {
+    .led_level = DEVICE_STATE_UNKNOWN,
+    .segment_digit = DEVICE_STATE_UNKNOWN,
+    .buzzer_freq = DEVICE_STATE_UNKNOWN,
+};
+
+// ===== 운영 지표 (STATS 명령, 지표 포트) =====
+// 모든 값은 원자 카운터/히스토그램이라 측정하는 스레드(I/O 루프, 액추에이터)와 내보내기 스레드가 잠금 없이 공유
+
+// 시간을 재는 장치 라이브러리 호출
+typedef enum DeviceCall {
+    DEVICE_CALL_LED_ON,
+    DEVICE_CALL_LED_OFF,
+    DEVICE_CALL_LED_SET_BRIGHTNESS,
+    DEVICE_CALL_BUZZER_TONE,
+    DEVICE_CALL_BUZZER_ON,
+    DEVICE_CALL_BUZZER_OFF,
+    DEVICE_CALL_SEGMENT_DISPLAY,
+    DEVICE_CALL_SENSOR_INIT,
+    DEVICE_CALL_SENSOR_GET_VALUE,
+    DEVICE_CALL_COUNT
+} DeviceCall;
+
+static const char *const device_call_names[DEVICE_CALL_COUNT] = {
+    "led_on", "led_off", "led_set_brightness", "buzzer_tone", "buzzer_on", "buzzer_off",
+    "segment_display", "sensor_init", "sensor_get_value",
+};
+
+#define EVENT_KIND_COUNT (PROTO_EVT_BUZZER_DONE + 1)
+
+static const char *const event_names[EVENT_KIND_COUNT] = {
+    [PROTO_EVT_CDS]                = "cds",
+    [PROTO_EVT_COUNTDOWN_COMPLETE] = "countdown_complete",
+    [PROTO_EVT_COUNTDOWN_STOPPED]  = "countdown_stopped",
+    [PROTO_EVT_QUIZ_TIMEOVER]      = "quiz_timeover",
+    [PROTO_EVT_SERVER_SHUTDOWN]    = "server_shutdown",
+    [PROTO_EVT_BUZZER_DONE]        = "buzzer_done",
+};
+
+typedef struct ServerMetrics {
+    uint64_t start_ns;                                  // 서버 시작 시각 (uptime)
+    LatencyHistogram commands;                          // 등록된 모든 명령의 처리 시간
+    atomic_ulong commands_unknown;                      // 등록되지 않은 동사/명령 코드
+    LatencyHistogram device_calls[DEVICE_CALL_COUNT];   // 장치 라이브러리 호출 시간
+    LatencyHistogram broadcasts;                        // 구독자가 있는 브로드캐스트 한 번의 큐 추가 시간
+    atomic_ulong events[EVENT_KIND_COUNT];              // 발생한 이벤트 수 (구독자 유무와 무관)
+    atomic_ulong events_dropped;                        // 느린 클라이언트 정책으로 버리거나 덮어쓴 이벤트
+    atomic_int connections;                             // 현재 연결 수
+    atomic_ulong connections_accepted;
+    atomic_ulong connections_rejected;                  // 최대 연결 수 초과
+    atomic_ulong lib_reloads;                           // 장치 라이브러리 재적재 성공 수
+    atomic_ulong lib_reload_failures;
+    LatencyHistogram command_queue;                     // 리액터가 넘긴 명령이 장치 소유 스레드에서 실행되기까지 대기 시간
+} ServerMetrics;
+
+static ServerMetrics server_metrics;
+
+// 연결별 입력 링 버퍼: recv 조각을 모아 개행('\n') 단위 명령 프레임으로 분리
+typedef struct InputRing {
+    char data[BUFFER_SIZE];
+    size_t head;     // 가장 오래된 바이트 위치
+    size_t len;      // 버퍼에 쌓인 바이트 수
+    size_t scanned;  // head부터 개행이 없음을 이미 확인한 바이트 수
+    int discarding;  // 텍스트: 길이 초과 명령의 나머지를 다음 개행까지 버리는 중, 바이너리: 거부한 BATCH의 남은 명령 프레임 수
+    int binary;      // BINARY_HELLO 줄 이후 입력을 8바이트 프레임으로 해석 (리액터 전용)
+} InputRing;
+
+// 송신 메시지 종류 (느린 클라이언트 정책 적용 대상 구분)
+typedef enum MessageKind {
+    MSG_RESPONSE,      // 명령 응답: 버리지 않음
+    MSG_EVENT,         // 브로드캐스트 이벤트: 큐가 가득 차면 오래된 것부터 버릴 수 있음
+    MSG_EVENT_SENSOR   // CDS 센서 이벤트: 미전송 이벤트를 최신 값으로 덮어쓸 수 있음
+} MessageKind;
+
+// 송신 큐가 가득 찬(느린) 클라이언트에 대한 정책
+typedef enum SlowClientPolicy {
+    SLOW_CLIENT_DROP_OLDEST,  // 가장 오래된 미전송 이벤트부터 버림
+    SLOW_CLIENT_COALESCE,     // 센서 이벤트는 미전송분을 최신 값으로 덮어쓰고, 그래도 가득 차면 오래된 이벤트를 버림
+    SLOW_CLIENT_DISCONNECT    // 연결 종료
+} SlowClientPolicy;
+
+static SlowClientPolicy slow_client_policy = SLOW_CLIENT_COALESCE;
+
+// 송신 메시지: 브로드캐스트 시 한 번만 만들고 모든 클라이언트 큐가 참조 카운트로 공유
+typedef struct OutMessage {
+    atomic_int refs;
+    MessageKind kind;
+    size_t len;
+    char data[];
+} OutMessage;
+
+// 클라이언트별 고정 크기 송신 큐 (I/O 루프가 비움)
+typedef struct OutputQueue {
+    OutMessage *msgs[OUT_QUEUE_LEN];
+    size_t head;           // 가장 오래된 메시지 위치
+    size_t count;          // 대기 중인 메시지 수
+    size_t head_offset;    // head 메시지 중 이미 전송한 바이트 수
+    size_t sending;        // head부터 io_uring 송신 요청에 넘긴 메시지 수 (완료 전까지 버리거나 바꾸지 않음)
+    unsigned long dropped; // 정책에 의해 버려진 이벤트 수
+} OutputQueue;
+
+// 클라이언트 핸들: 하위 16비트 = 슬롯 번호, 상위 16비트 = 세대 (재사용된 슬롯의 옛 핸들 구분)
+typedef uint32_t ClientHandle;
 
 typedef struct ClientContext {
+    atomic_int refs;           // 레지스트리 1 + 브로드캐스트 스냅샷 수 + 실행 대기 명령 수 (0이 되면 해제)
+    ClientHandle handle;
     int socket_fd;
     struct sockaddr_in addr;
+    struct Reactor *reactor;   // 이 연결의 소켓 I/O를 맡은 리액터 (수락 후 변경 없음)
+    int reactor_pos;           // reactor->clients 내 위치
+    InputRing in;
+    pthread_mutex_t out_lock;  // 송신 큐 보호 (리액터 ↔ 장치 소유 스레드 ↔ 브로드캐스트 스레드)
+    OutputQueue out;
+    int binary;                // 바이너리 응답 형식으로 전환됨 (out_lock 보호, 전환 후 되돌리지 않음)
+    int want_write;            // EPOLLOUT 등록 여부 (리액터 전용)
+    struct iovec send_iov[OUT_IOV_MAX];  // io_uring 송신 중인 메시지들 (완료 전까지 유지, 리액터 전용)
+    struct msghdr send_msg;
+    atomic_int doomed;         // 정책에 의해 연결 종료 예정
+    atomic_int jobs;           // 장치 소유 스레드에 넘겼지만 아직 실행하지 않은 명령 프레임 수
+    atomic_uint topics;        // 구독 중인 이벤트 주제 비트 (PROTO_TOPIC_*, 변경은 레지스트리 잠금 안에서)
+    char *batch;               // BATCH ~ END 사이에 받은 명령 줄 ('\0'로 구분, NULL = 수집 중 아님, 장치 소유 스레드 전용)
+    size_t batch_len;
+    int batch_count;
+    int batch_overflow;        // BATCH_MAX_OPS 또는 버퍼 크기 초과 (END에서 전체 거부)
 } ClientContext;
 
+// 연결된 클라이언트 레지스트리: 시작 시 한 번 할당하는 고정 크기 슬롯 배열
+// - 추가/제거 O(1): 빈 슬롯 스택 + 사용 중 슬롯 번호를 빽빽하게 모은 active 배열(제거 시 마지막과 교환)
+// - 추가/제거는 각 리액터 스레드가 잠금 안에서 수행
+// - 순회는 잠금 상태에서 참조 카운트를 올린 스냅샷으로 하고, 잠금 없는 active 순회는
+//   다른 리액터를 멈춘 동안(reactors_pause)의 I/O 루프나 리액터 시작 전에만 허용
+typedef struct ClientSlot {
+    ClientContext *ctx;   // NULL이면 빈 슬롯
+    uint32_t generation;  // 슬롯이 해제될 때마다 증가
+    int active_pos;       // active 배열 내 위치
+} ClientSlot;
+
+typedef struct ClientRegistry {
+    atomic_int topic_subscribers[PROTO_TOPIC_COUNT];  // 주제별 구독 연결 수 (아무도 없으면 메시지 생성 생략)
+    ClientSlot *slots;
+    int *free_stack;      // 빈 슬롯 번호 스택
+    int free_top;
+    int *active;          // 사용 중인 슬롯 번호 (0 ~ count-1)
+    int count;
+    int capacity;         // 최대 동시 연결 수 (초기화 후 변경 없음)
+    pthread_mutex_t lock; // 스냅샷 ↔ 추가/제거 보호
+} ClientRegistry;
+
+static ClientRegistry client_registry = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+// 리액터: SO_REUSEPORT 리스닝 소켓 하나와 그 소켓으로 받은 연결들을 epoll 하나로 처리하는 스레드
+// - 커널이 새 연결을 리스닝 소켓들에 나눠 주므로 수락/수신/송신이 코어 수만큼 병렬로 진행
+// - 0번은 메인 I/O 루프로, 장치 소유 스레드를 겸함 (명령 실행, 타이머, 센서, 저널, 재적재, 서버 교체)
+// - 나머지 리액터는 완성된 명령 프레임을 명령 큐(cmdqueue.c)로 0번에 넘기고, 응답은 송신 큐로 돌려받아 보냄
+typedef struct Reactor {
+    int id;
+    int epoll_fd;
+    int wake_fd;              // 송신할 응답/브로드캐스트가 있음을 알리는 eventfd
+    int listen_fd;
+    pthread_t thread;
+    ClientContext **clients;  // 이 리액터의 연결 (리액터 스레드 전용, 제거 시 마지막과 교환)
+    int client_count;
+    IoRing *ring;             // io_uring 백엔드일 때 이 리액터 스레드가 만든 링 (NULL = epoll)
+    int ring_ops;             // 완료를 기다리는 링 요청 수 (다중 요청은 마지막 완료까지 1개)
+    int ring_paused;          // 요청을 모두 취소하고 새로 등록하지 않는 중 (reactors_pause)
+    atomic_ulong accepted;    // 이 리스닝 소켓으로 수락한 연결 수
+    atomic_ulong waits;       // epoll_wait / io_uring_enter 대기 호출 수
+} Reactor;
+
+// 연결 I/O 백엔드 (시작 시 DEVICE_SERVER_IO로 선택, io_uring을 쓸 수 없으면 epoll)
+typedef enum IoBackend {
+    IO_BACKEND_EPOLL,
+    IO_BACKEND_URING
+} IoBackend;
+
+static IoBackend io_backend = IO_BACKEND_EPOLL;
+
+static const char *io_backend_name(void)
+{
+    return io_backend == IO_BACKEND_URING ? "uring" : "epoll";
+}
+
+static Reactor *reactors = NULL;
+static int reactor_count = 0;
+static int reactor_threads = 0;  // 시작한 작업 리액터 스레드 수 (0번 제외)
+
+static int epoll_fd = -1;    // I/O 루프(리액터 0) epoll 인스턴스
+static int handoff_listen_fd = -1;  // 다음 서버가 교체를 요청할 Unix 소켓 (-1 = 교체 불가)
+static int loop_wake_fd = -1;  // 다른 스레드가 I/O 루프를 깨우는 eventfd (리액터 0의 wake_fd)
+static CmdQueue command_queue;  // 작업 리액터 → 장치 소유 스레드 명령 프레임
+static volatile sig_atomic_t shutdown_requested = 0;
+static volatile sig_atomic_t reload_requested = 0;  // SIGHUP: I/O 루프에서 장치 라이브러리 재적재
+static unsigned int libs_generation = 0;  // 재적재 성공 횟수 (RELOAD 응답 value)
+
 // 함수 선언 (forward declaration)
-static void *cds_monitor_thread_func(void *arg);
-static void *segment_countdown_thread_func(void *arg);
-static void *quiz_thread_func(void *arg);
-static void add_client_to_list(int socket_fd);
-static void remove_client_from_list(int socket_fd);
-static void broadcast_to_clients(const char *message);
+static int client_registry_snapshot(ClientContext **out);
+static void client_release(ClientContext *ctx);
+static void broadcast_to_clients(const char *message, ProtoEvent event);
+static void broadcast_event(const char *message, MessageKind kind, ProtoEvent event, int value);
+static int flush_client(ClientContext *ctx);
+static int cds_monitor_start(int stable);
+static void cds_monitor_stop(void);
+static void cds_monitor_on_edge(void);
+static ProtoStatus device_libs_reload(char *detail, size_t size);
+static void device_libs_reclaim(void *arg);
 
 // 실행 파일의 디렉토리 경로를 반환 (데몬 프로세스에서 상대 경로 문제 해결)
 static char* get_exe_directory(void) {
@@ -192,6 +425,54 @@ static char* get_exe_directory(void) {
     return NULL;
 }
 
+// 부저 패턴 설정 파일 경로 (로그 파일과 같은 misc/ 디렉토리)
+static const char* get_buzzer_pattern_path(void) {
+    static char pattern_path[2100] = {0};
+
+    if (pattern_path[0] == '\0') {
+        char *path_copy = strdup(get_log_file_path());
+        if (path_copy) {
+            snprintf(pattern_path, sizeof(pattern_path), "%s/buzzer_patterns.conf", dirname(path_copy));
+            free(path_copy);
+        } else {
+            snprintf(pattern_path, sizeof(pattern_path), "./misc/buzzer_patterns.conf");
+        }
+    }
+    return pattern_path;
+}
+
+// 장치 상태 저널 파일 경로 (로그 파일과 같은 misc/ 디렉토리)
+static const char* get_journal_path(void) {
+    static char journal_path[2100] = {0};
+
+    if (journal_path[0] == '\0') {
+        char *path_copy = strdup(get_log_file_path());
+        if (path_copy) {
+            snprintf(journal_path, sizeof(journal_path), "%s/device_journal.bin", dirname(path_copy));
+            free(path_copy);
+        } else {
+            snprintf(journal_path, sizeof(journal_path), "./misc/device_journal.bin");
+        }
+    }
+    return journal_path;
+}
+
+// 교체 요청 소켓 경로 (로그 파일과 같은 misc/ 디렉토리)
+static const char* get_handoff_path(void) {
+    static char handoff_path[2100] = {0};
+
+    if (handoff_path[0] == '\0') {
+        char *path_copy = strdup(get_log_file_path());
+        if (path_copy) {
+            snprintf(handoff_path, sizeof(handoff_path), "%s/device_server.sock", dirname(path_copy));
+            free(path_copy);
+        } else {
+            snprintf(handoff_path, sizeof(handoff_path), "./misc/device_server.sock");
+        }
+    }
+    return handoff_path;
+}
+
 // PID 파일 경로를 동적으로 생성하는 함수
 static const char* get_pid_file_path(void) {
     static char pid_path[2048] = {0};
@@ -209,83 +490,139 @@ static const char* get_pid_file_path(void) {
     return pid_path;
 }
 
-// ===== 시그널 핸들러 (나중에 데몬 프로세스로 변환할 때 사용) =====
+// I/O 루프 깨우기 (시그널 핸들러에서도 호출 가능: write만 사용)
+static void wake_event_loop(void) {
+    uint64_t one = 1;
+    if (loop_wake_fd >= 0 && write(loop_wake_fd, &one, sizeof(one)) < 0) {
+        // 이미 깨울 신호가 쌓여 있으면 무시
+    }
+}
+
+// 리액터 하나 깨우기: 송신 큐에 쌓인 메시지 전송, 정책상 종료된 연결 정리
+static void wake_reactor(Reactor *r) {
+    uint64_t one = 1;
+    if (r->wake_fd >= 0 && write(r->wake_fd, &one, sizeof(one)) < 0) {
+        // 이미 깨울 신호가 쌓여 있으면 무시
+    }
+}
+
+// 모든 리액터 깨우기 (브로드캐스트 후)
+static void wake_reactors(void) {
+    if (!reactors) {
+        wake_event_loop();
+        return;
+    }
+    for (int i = 0; i < reactor_count; ++i) {
+        wake_reactor(&reactors[i]);
+    }
+}
+
+// ===== 시그널 핸들러 =====
+// 요청만 표시하고 I/O 루프를 깨움 (실제 종료/재적재는 I/O 루프에서 수행)
 void signal_handler(int sig) {
     if (sig == SIGTERM || sig == SIGINT) {
-        log_event("서버 종료 중...");
-        
-        // 모든 연결된 클라이언트에게 서버 종료 메시지 브로드캐스트
-        broadcast_to_clients("SERVER_SHUTDOWN\n");
-        usleep(100000);  // 메시지 전송 시간 확보 (0.1초)
-        
-        // CDS 모니터링 스레드 종료
-        if (cds_thread_created) {
-            cds_monitor_running = 0;
-            pthread_join(cds_monitor_thread, NULL);
-        }
-        
-        // 7SEG 카운트다운 스레드 종료
-        if (segment_thread_created) {
-            segment_countdown_running = 0;
-            pthread_join(segment_countdown_thread, NULL);
-        }
-        
-        // 퀴즈 스레드 종료
-        pthread_mutex_lock(&quiz_mutex);
-        if (quiz_running) {
-            quiz_running = 0;
-        }
-        pthread_mutex_unlock(&quiz_mutex);
-        
-        if (server_socket != -1) {
-            close(server_socket);
-        }
-        // 통합 라이브러리 언로드
-        if (g_libs.device_handle) {
-            dlclose(g_libs.device_handle);
-        }
-        // PID 파일 삭제
-        unlink(get_pid_file_path());
-        exit(0);
-    }
-}
-
-static void *load_library(const char *path) {
-    void *handle = dlopen(path, RTLD_LAZY);
+        shutdown_requested = 1;
+        wake_event_loop();
+    } else if (sig == SIGHUP) {
+        reload_requested = 1;
+        wake_event_loop();
+    }
+}
+
+static void reactors_pause(void);
+static void reactors_resume(void);
+
+// 서버 종료 처리 (I/O 루프 스레드에서 호출)
+static void shutdown_server(void) {
+    log_event("서버 종료 중...");
+
+    // 다른 리액터를 멈춘 뒤 마지막 송신 (같은 연결에 두 스레드가 동시에 쓰지 않도록)
+    reactors_pause();
+
+    // 모든 연결된 클라이언트에게 서버 종료 메시지 브로드캐스트 후 즉시 송신
+    broadcast_to_clients("SERVER_SHUTDOWN\n", PROTO_EVT_SERVER_SHUTDOWN);
+    ClientContext *snapshot[SNAPSHOT_STACK];
+    ClientContext **clients = client_registry.capacity <= SNAPSHOT_STACK
+        ? snapshot : malloc(sizeof(ClientContext *) * client_registry.capacity);
+    if (clients) {
+        int n = client_registry_snapshot(clients);
+        for (int i = 0; i < n; ++i) {
+            flush_client(clients[i]);
+            client_release(clients[i]);
+        }
+        if (clients != snapshot) free(clients);
+    }
+
+    // 예약된 장치 동작 취소 (CDS 모니터링, 카운트다운, 퀴즈)
+    cds_monitor_stop();
+    timer_cancel(&segment_countdown_task);
+    timer_cancel(&quiz_task);
+    quiz_running = 0;
+
+    // 부저 액추에이터 스레드 종료 (라이브러리 언로드 전)
+    actuator_stop();
+    device_libs_reclaim(NULL);  // 재적재 후 해제 대기 중인 이전 라이브러리 (읽는 스레드가 더는 없음)
+
+    // 마지막 상태를 체크포인트로 남기고 저널 닫기
+    journal_close();
+
+    for (int i = 0; i < reactor_count; ++i) {
+        if (reactors[i].listen_fd != -1) {
+            close(reactors[i].listen_fd);
+        }
+    }
+    if (handoff_listen_fd != -1) {
+        close(handoff_listen_fd);
+        unlink(get_handoff_path());
+    }
+    // 통합 라이브러리 언로드
+    if (device_libs()->device_handle) {
+        dlclose(device_libs()->device_handle);
+    }
+    // PID 파일 삭제
+    unlink(get_pid_file_path());
+    exit(0);
+}
+
+static void *load_library(const char *path, int flags) {
+    void *handle = dlopen(path, flags);
     if (!handle) {
         char log_msg[512];
         snprintf(log_msg, sizeof(log_msg), "라이브러리 로드 실패 (%s): %s", path, dlerror());
-        log_event(log_msg);
+        log_event_level(LOG_LEVEL_ERROR, log_msg);
     }
     return handle;
 }
 
-static int load_symbols(DeviceLibs *libs) {
-    dlerror(); // 에러 상태 초기화
+// 통합 장치 라이브러리 경로 (시작과 RELOAD 모두 같은 경로에서 읽음)
+// 실행 파일이 exec/server에 있으므로, 라이브러리는 exec/lib/에 있음
+// DEVICE_MANAGE_LIB 환경 변수로 다른 라이브러리 선택 가능 (예: libdevice_manage_sim.so)
+static const char* get_device_lib_path(void) {
+    static char lib_path[2048] = {0};
 
-    // 실행 파일의 디렉토리 경로 얻기
-    char *exe_dir = get_exe_directory();
-    if (!exe_dir) {
-        log_event("실행 파일 디렉토리를 찾을 수 없습니다.");
-        return -1;
-    }
-    
-    // 절대 경로로 라이브러리 경로 구성
-    // 실행 파일이 exec/server에 있으므로, 라이브러리는 exec/lib/에 있음
-    char lib_path[2048];
-    snprintf(lib_path, sizeof(lib_path), "%s/lib/libdevice_manage.so", exe_dir);
-    
-    // 통합 장치 라이브러리 로드
-    libs->device_handle = load_library(lib_path);
-    if (!libs->device_handle) {
-        char log_msg[2560];
-        snprintf(log_msg, sizeof(log_msg), "통합 장치 라이브러리 로드 실패: %s", lib_path);
-        log_event(log_msg);
-        return -1;
+    if (lib_path[0] == '\0') {
+        char *exe_dir = get_exe_directory();
+        if (!exe_dir) {
+            return NULL;
+        }
+        const char *lib_name = getenv("DEVICE_MANAGE_LIB");
+        if (!lib_name || !*lib_name) {
+            lib_name = "libdevice_manage.so";
+        }
+        if (lib_name[0] == '/') {
+            snprintf(lib_path, sizeof(lib_path), "%s", lib_name);
+        } else {
+            snprintf(lib_path, sizeof(lib_path), "%s/lib/%s", exe_dir, lib_name);
+        }
     }
+    return lib_path;
+}
 
-    // 전체 초기화 함수
+// 열린 핸들에서 장치 함수 심볼을 찾아 표 구성 (필수 심볼이 없으면 -1)
+static int resolve_symbols(DeviceLibs *libs) {
+    // 전체 초기화/정리 함수
     libs->device_init_all = (device_init_all_t)dlsym(libs->device_handle, "device_init_all");
+    libs->device_release_all = (device_release_all_t)dlsym(libs->device_handle, "device_release_all");
 
     // LED 함수들
     libs->led_init = (led_init_t)dlsym(libs->device_handle, "led_init");
@@ -301,6 +638,7 @@ static int load_symbols(DeviceLibs *libs) {
     libs->buzzer_emergency = (buzzer_emergency_t)dlsym(libs->device_handle, "buzzer_emergency");
     libs->buzzer_success   = (buzzer_success_t)dlsym(libs->device_handle, "buzzer_success");
     libs->buzzer_fail      = (buzzer_fail_t)dlsym(libs->device_handle, "buzzer_fail");
+    libs->buzzer_tone      = (buzzer_tone_t)dlsym(libs->device_handle, "buzzer_tone");
 
     // 7SEG 함수들
     libs->segment_init      = (segment_init_t)dlsym(libs->device_handle, "segment_init");
@@ -310,14 +648,38 @@ static int load_symbols(DeviceLibs *libs) {
     // CDS 센서 함수들
     libs->sensor_init      = (sensor_init_t)dlsym(libs->device_handle, "sensor_init");
     libs->sensor_get_value = (sensor_get_value_t)dlsym(libs->device_handle, "sensor_get_value");
+    libs->sensor_edge_fd   = (sensor_edge_fd_t)dlsym(libs->device_handle, "sensor_edge_fd");
 
     // 필수 장치 심볼 로딩 확인
     if (!libs->led_on || !libs->led_off || !libs->buzzer_on || !libs->buzzer_off ||
         !libs->segment_display || !libs->sensor_get_value) {
-        log_event("필수 장치 심볼 로딩 실패");
+        log_event_level(LOG_LEVEL_ERROR, "필수 장치 심볼 로딩 실패");
         return -1;
     }
-    
+    return 0;
+}
+
+static int load_symbols(DeviceLibs *libs) {
+    dlerror(); // 에러 상태 초기화
+
+    const char *lib_path = get_device_lib_path();
+    if (!lib_path) {
+        log_event_level(LOG_LEVEL_ERROR, "실행 파일 디렉토리를 찾을 수 없습니다.");
+        return -1;
+    }
+
+    // 통합 장치 라이브러리 로드
+    libs->device_handle = load_library(lib_path, RTLD_LAZY);
+    if (!libs->device_handle) {
+        char log_msg[2560];
+        snprintf(log_msg, sizeof(log_msg), "통합 장치 라이브러리 로드 실패: %s", lib_path);
+        log_event_level(LOG_LEVEL_ERROR, log_msg);
+        return -1;
+    }
+    if (resolve_symbols(libs) < 0) {
+        return -1;
+    }
+
     // 전체 장치 초기화
     if (libs->device_init_all) {
         libs->device_init_all();
@@ -326,535 +688,2968 @@ static int load_symbols(DeviceLibs *libs) {
     return 0;
 }
 
-// 클라이언트 목록에 추가
-static void add_client_to_list(int socket_fd) {
-    ClientList *new_client = malloc(sizeof(ClientList));
-    if (!new_client) {
-        perror("클라이언트 목록 노드 할당 실패");
-        return;
+// 레지스트리 초기화 (시작 시 1회, 최대 연결 수만큼 슬롯을 미리 할당)
+static int client_registry_init(int capacity) {
+    ClientRegistry *r = &client_registry;
+
+    r->slots = calloc(capacity, sizeof(ClientSlot));
+    r->free_stack = malloc(sizeof(int) * capacity);
+    r->active = malloc(sizeof(int) * capacity);
+    if (!r->slots || !r->free_stack || !r->active) {
+        return -1;
     }
-    
-    new_client->socket_fd = socket_fd;
-    
-    pthread_mutex_lock(&client_list_mutex);
-    new_client->next = client_list_head;
-    client_list_head = new_client;
-    pthread_mutex_unlock(&client_list_mutex);
-}
-
-// 클라이언트 목록에서 제거 (내부 함수, 뮤텍스 잠금 전제)
-static void remove_client_from_list_locked(int socket_fd) {
-    ClientList **curr = &client_list_head;
-    while (*curr) {
-        if ((*curr)->socket_fd == socket_fd) {
-            ClientList *to_remove = *curr;
-            *curr = (*curr)->next;
-            free(to_remove);
-            break;
-        }
-        curr = &((*curr)->next);
+    // 낮은 번호 슬롯부터 사용하도록 역순으로 쌓음
+    for (int i = 0; i < capacity; ++i) {
+        r->free_stack[i] = capacity - 1 - i;
     }
+    r->free_top = capacity;
+    r->count = 0;
+    r->capacity = capacity;
+    return 0;
 }
 
-// 클라이언트 목록에서 제거 (공개 함수)
-static void remove_client_from_list(int socket_fd) {
-    pthread_mutex_lock(&client_list_mutex);
-    remove_client_from_list_locked(socket_fd);
-    pthread_mutex_unlock(&client_list_mutex);
+// 주제별 구독 수 증감 (레지스트리 잠금 상태에서 호출)
+static void topic_count_locked(unsigned int topics, int delta) {
+    for (int i = 0; i < PROTO_TOPIC_COUNT; ++i) {
+        if (topics & (1u << i)) {
+            atomic_fetch_add(&client_registry.topic_subscribers[i], delta);
+        }
+    }
 }
 
-// 모든 연결된 클라이언트에 메시지 브로드캐스트
-static void broadcast_to_clients(const char *message) {
-    if (!message) return;
-    
-    pthread_mutex_lock(&client_list_mutex);
-    
-    ClientList *curr = client_list_head;
-    ClientList *prev = NULL;
-    
-    while (curr) {
-        // 소켓이 유효한지 확인하고 메시지 전송
-        if (send(curr->socket_fd, message, strlen(message), 0) < 0) {
-            // 전송 실패 시 목록에서 제거 (연결이 끊어진 것으로 간주)
-            ClientList *to_remove = curr;
-            if (prev) {
-                prev->next = curr->next;
-            } else {
-                client_list_head = curr->next;
-            }
-            curr = curr->next;
-            free(to_remove);
-            continue;
-        }
-        prev = curr;
-        curr = curr->next;
+// 클라이언트 등록 후 핸들 설정 (연결을 맡은 리액터에서 호출), 가득 차면 -1
+static int client_registry_add(ClientContext *ctx) {
+    ClientRegistry *r = &client_registry;
+
+    pthread_mutex_lock(&r->lock);
+    if (r->free_top == 0) {
+        pthread_mutex_unlock(&r->lock);
+        return -1;
     }
-    
-    pthread_mutex_unlock(&client_list_mutex);
+    int index = r->free_stack[--r->free_top];
+    ClientSlot *slot = &r->slots[index];
+    slot->ctx = ctx;
+    slot->active_pos = r->count;
+    r->active[r->count++] = index;
+    ctx->handle = (slot->generation << CLIENT_SLOT_BITS) | (uint32_t)index;
+    topic_count_locked(atomic_load(&ctx->topics), 1);
+    pthread_mutex_unlock(&r->lock);
+    atomic_fetch_add(&server_metrics.connections, 1);
+    atomic_fetch_add(&server_metrics.connections_accepted, 1);
+    return 0;
 }
 
-// 클라이언트 명령을 장치 제어 함수로 매핑
-static const char *handle_command(DeviceLibs *libs, const char *cmd) {
-    if (!cmd) return "INVALID COMMAND\n";
-
-    if (strncmp(cmd, "LED_ON", 6) == 0) {
-        libs->led_on();
-        return "LED ON OK\n";
-    } else if (strncmp(cmd, "LED_OFF", 7) == 0) {
-        libs->led_off();
-        return "LED OFF OK\n";
-    } else if (strncmp(cmd, "LED_BRIGHTNESS", 14) == 0) {
-        int level = atoi(cmd + 15);
-        libs->led_set_brightness(level);
-        return "LED BRIGHTNESS OK\n";
-    } else if (strncmp(cmd, "BUZZER_ON", 9) == 0) {
-        libs->buzzer_on();
-        return "BUZZER ON OK\n";
-    } else if (strncmp(cmd, "BUZZER_OFF", 10) == 0) {
-        libs->buzzer_off();
-        return "BUZZER OFF OK\n";
-    } else if (strncmp(cmd, "SEGMENT_DISPLAY", 15) == 0) {
-        // 입력한 숫자를 그냥 표시만 함 (즉시 처리)
-        int number = atoi(cmd + 16);
-        if (number < 0 || number > 9) {
-            return "SEGMENT DISPLAY FAILED (범위: 0-9)\n";
-        }
-        libs->segment_display(number);
-        return "SEGMENT DISPLAY OK\n";
-    } else if (strncmp(cmd, "SEGMENT_COUNTDOWN", 17) == 0) {
-        // 입력한 숫자부터 카운트다운 시작
-        int number = atoi(cmd + 18);
-        if (number < 0 || number > 9) {
-            return "SEGMENT COUNTDOWN FAILED (범위: 0-9)\n";
-        }
-        
-        // 7SEG 카운트다운 스레드 시작
-        pthread_mutex_lock(&segment_countdown_mutex);
-        if (!segment_thread_created) {
-            // 스레드가 아직 생성되지 않았으면 생성
-            segment_countdown_running = 1;
-            // 스레드에 전달할 숫자를 저장하기 위한 동적 할당
-            int *start_number = malloc(sizeof(int));
-            if (!start_number) {
-                pthread_mutex_unlock(&segment_countdown_mutex);
-                return "SEGMENT COUNTDOWN FAILED (메모리 할당 실패)\n";
-            }
-            *start_number = number;
-            
-            if (pthread_create(&segment_countdown_thread, NULL, segment_countdown_thread_func, start_number) == 0) {
-                segment_thread_created = 1;
-                pthread_mutex_unlock(&segment_countdown_mutex);
-                return "SEGMENT COUNTDOWN OK\n";
-            } else {
-                perror("7SEG 카운트다운 스레드 생성 실패");
-                segment_countdown_running = 0;
-                free(start_number);
-                pthread_mutex_unlock(&segment_countdown_mutex);
-                return "SEGMENT COUNTDOWN FAILED\n";
-            }
-        } else {
-            // 스레드가 이미 실행 중이면 거부
-            pthread_mutex_unlock(&segment_countdown_mutex);
-            return "SEGMENT COUNTDOWN ALREADY RUNNING\n";
-        }
-    } else if (strncmp(cmd, "SEGMENT_STOP", 12) == 0) {
-        // 7SEG 카운트다운 스레드 중지
-        pthread_mutex_lock(&segment_countdown_mutex);
-        if (segment_thread_created && segment_countdown_running) {
-            segment_countdown_running = 0;
-            pthread_mutex_unlock(&segment_countdown_mutex);
-            // 스레드 종료 대기
-            pthread_join(segment_countdown_thread, NULL);
-            segment_thread_created = 0;
-            //libs->segment_display(0);
-            return "SEGMENT STOP OK\n";
-        } else {
-            pthread_mutex_unlock(&segment_countdown_mutex);
-            return "SEGMENT NOT RUNNING\n";
-        }
-    } else if (strncmp(cmd, "QUIZ_START", 10) == 0) {
-        // 퀴즈 시작: 5초 카운트다운 + 부저
-        pthread_mutex_lock(&quiz_mutex);
-        if (quiz_running) {
-            pthread_mutex_unlock(&quiz_mutex);
-            return "QUIZ ALREADY RUNNING\n";
-        }
-        quiz_correct = 0;
-        if (pthread_create(&quiz_thread, NULL, quiz_thread_func, NULL) != 0) {
-            pthread_mutex_unlock(&quiz_mutex);
-            return "QUIZ START FAILED\n";
-        }
-        pthread_detach(quiz_thread);
-        pthread_mutex_unlock(&quiz_mutex);
-        return "QUIZ START: 이 프로젝트의 점수는? (5초 안에 100을 입력하세요!)\n";
-    } else if (strncmp(cmd, "QUIZ_ANSWER", 11) == 0) {
-        // 사용자가 입력한 정답 확인
-        if (!quiz_running) {
-            return "QUIZ NOT RUNNING\n";
-        }
-        // 공백 다음 숫자 파싱
-        const char *arg = cmd + 11;
-        while (*arg == ' ') arg++;
-        int ans = atoi(arg);
-
-        if (ans == 100) {
-            // 정답
-            quiz_correct = 1;
-            return "QUIZ CORRECT: 정답입니다!\n";
-        } else {
-            // 오답: warning 패턴 1회
-            if (libs->buzzer_warning) {
-                libs->buzzer_warning();
-            } else if (libs->buzzer_on && libs->buzzer_off) {
-                libs->buzzer_on();
-                usleep(150000);
-                libs->buzzer_off();
-            }
-            return "QUIZ WRONG: 다시 입력하세요\n";
-        }
-    } else if (strncmp(cmd, "SENSOR_ON", 9) == 0) {
-        // CDS 센서 모니터링 스레드 시작
-        pthread_mutex_lock(&cds_monitor_mutex);
-        if (!cds_thread_created) {
-            // 스레드가 아직 생성되지 않았으면 생성
-            if (libs->sensor_init && libs->sensor_get_value) {
-                cds_monitor_running = 1;
-                if (pthread_create(&cds_monitor_thread, NULL, cds_monitor_thread_func, NULL) == 0) {
-                    cds_thread_created = 1;
-                    
-                    pthread_mutex_unlock(&cds_monitor_mutex);
-                    return "SENSOR ON OK\n";
-                } else {
-                    perror("CDS 모니터링 스레드 생성 실패");
-                    cds_monitor_running = 0;
-                    pthread_mutex_unlock(&cds_monitor_mutex);
-                    return "SENSOR ON FAILED\n";
-                }
-            } else {
-                pthread_mutex_unlock(&cds_monitor_mutex);
-                return "SENSOR LIBRARY NOT AVAILABLE\n";
-            }
-        } else {
-            // 스레드가 이미 생성되어 있으면 실행 플래그만 활성화
-            if (!cds_monitor_running) {
-                cds_monitor_running = 1;
-                log_event("CDS 센서 모니터링 재개됨 (상태 초기화)");
-                // 재시작 시 상태 초기화를 위해 짧은 대기 후 센서 값 다시 읽기
-                pthread_mutex_unlock(&cds_monitor_mutex);
-                return "SENSOR ON OK\n";
-            } else {
-                pthread_mutex_unlock(&cds_monitor_mutex);
-                return "SENSOR ALREADY ON\n";
-            }
-        }
-    } else if (strncmp(cmd, "SENSOR_OFF", 10) == 0) {
-        pthread_mutex_lock(&cds_monitor_mutex);
-        if (cds_thread_created) {
-            cds_monitor_running = 0; // 플래그를 꺼서 루프 탈출 유도
-            pthread_mutex_unlock(&cds_monitor_mutex); // Join 대기를 위해 뮤텍스 해제
-            
-            pthread_join(cds_monitor_thread, NULL); // 스레드가 완전히 종료될 때까지 대기
-            
-            pthread_mutex_lock(&cds_monitor_mutex);
-            cds_thread_created = 0; // 이제 확실히 새로 생성 가능한 상태
-            pthread_mutex_unlock(&cds_monitor_mutex);
-            
-            log_event("CDS 센서 모니터링 완전히 종료됨");
-            return "SENSOR OFF OK\n";
-        }
-        pthread_mutex_unlock(&cds_monitor_mutex);
-        return "SENSOR ALREADY OFF\n";
-    }
-    return "UNKNOWN COMMAND\n";
-}
-
-// 클라이언트별 처리 스레드: 클라이언트가 끊을 때까지 반복 수신/응답
-static void *client_thread(void *arg)
-{
-    ClientContext *ctx = (ClientContext *)arg;
-    int client_socket = ctx->socket_fd;
-    struct sockaddr_in addr = ctx->addr;
-    free(ctx);
+// 클라이언트 등록 해제 (연결을 맡은 리액터에서 호출): active 배열의 마지막 항목을 빈 자리로 옮김
+static void client_registry_remove(ClientContext *ctx) {
+    ClientRegistry *r = &client_registry;
+    int index = (int)(ctx->handle & ((1u << CLIENT_SLOT_BITS) - 1));
 
-    char buffer[BUFFER_SIZE];
-    char log_msg[512];
+    pthread_mutex_lock(&r->lock);
+    ClientSlot *slot = &r->slots[index];
+    if (slot->ctx == ctx) {
+        int pos = slot->active_pos;
+        int last = r->active[--r->count];
+        r->active[pos] = last;
+        r->slots[last].active_pos = pos;
 
-    snprintf(log_msg, sizeof(log_msg), "클라이언트 연결됨: %s:%d",
-             inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
-    log_event(log_msg);
+        slot->ctx = NULL;
+        slot->generation = (slot->generation + 1) & 0xFFFF;
+        r->free_stack[r->free_top++] = index;
+        topic_count_locked(atomic_load(&ctx->topics), -1);
+        atomic_fetch_sub(&server_metrics.connections, 1);
+    }
+    pthread_mutex_unlock(&r->lock);
+}
 
-    // 클라이언트 목록에 추가
-    add_client_to_list(client_socket);
+// 연결의 구독 주제 변경 (명령 핸들러, 장치 소유 스레드), 주제별 구독 수도 함께 갱신
+static void client_set_topics(ClientContext *ctx, unsigned int topics) {
+    ClientRegistry *r = &client_registry;
 
-    while (1) {
-        memset(buffer, 0, BUFFER_SIZE);
-        int bytes_received = recv(client_socket, buffer, BUFFER_SIZE - 1, 0);
-        if (bytes_received <= 0) {
-            // 클라이언트 종료 또는 오류
-            break;
-        }
+    pthread_mutex_lock(&r->lock);
+    topic_count_locked(atomic_load(&ctx->topics), -1);
+    atomic_store(&ctx->topics, topics);
+    topic_count_locked(topics, 1);
+    pthread_mutex_unlock(&r->lock);
+}
 
-        buffer[bytes_received] = '\0';
-        snprintf(log_msg, sizeof(log_msg), "수신된 메시지: %.*s", (int)(sizeof(log_msg) - 30), buffer);
-        log_event(log_msg);
+// 현재 연결된 클라이언트 목록 복사 (각 항목의 참조 카운트 증가, 사용 후 client_release 필요)
+// out은 capacity 이상의 크기여야 함
+static int client_registry_snapshot(ClientContext **out) {
+    ClientRegistry *r = &client_registry;
 
-        const char *response = handle_command(&g_libs, buffer);
-        send(client_socket, response, strlen(response), 0);
+    pthread_mutex_lock(&r->lock);
+    int n = r->count;
+    for (int i = 0; i < n; ++i) {
+        ClientContext *ctx = r->slots[r->active[i]].ctx;
+        atomic_fetch_add(&ctx->refs, 1);
+        out[i] = ctx;
     }
+    pthread_mutex_unlock(&r->lock);
+    return n;
+}
 
-    // 클라이언트 목록에서 제거
-    remove_client_from_list(client_socket);
-    
-    close(client_socket);
-    snprintf(log_msg, sizeof(log_msg), "클라이언트 연결 종료: %s:%d",
-             inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
-    log_event(log_msg);
-    return NULL;
+// ===== 클라이언트별 송신 큐 =====
+
+static OutMessage *out_message_new(MessageKind kind, const char *data, size_t len) {
+    OutMessage *msg = malloc(sizeof(OutMessage) + len);
+    if (!msg) return NULL;
+    atomic_init(&msg->refs, 1);
+    msg->kind = kind;
+    msg->len = len;
+    memcpy(msg->data, data, len);
+    return msg;
 }
 
-// CDS 센서 모니터링 스레드: 지속적으로 센서 값을 읽어 LED 자동 제어
-static void *cds_monitor_thread_func(void *arg)
-{
-    (void)arg;  // 사용하지 않는 매개변수 경고 제거
-    
-    log_event("CDS 센서 모니터링 스레드 시작");
-    
-    // 센서 초기화
-    if (g_libs.sensor_init && g_libs.sensor_init() < 0) {
-        log_event("CDS 센서 초기화 실패");
-        return NULL;
+static void out_message_release(OutMessage *msg) {
+    if (atomic_fetch_sub(&msg->refs, 1) == 1) {
+        free(msg);
     }
-    
-    int last_value = -1;  // 이전 센서 값 (중복 제어 방지)
-    int first_read = 1;   // 첫 읽기 플래그 (재시작 시 초기화)
-    
-    while (cds_monitor_running) {
-        if (g_libs.sensor_get_value) {
-            int value = 0;
-            if (g_libs.sensor_get_value(&value) == 0) {
-                // 첫 읽기이거나 센서 값이 변경되었을 때만 LED 제어 및 클라이언트에 알림
-                if (first_read || value != last_value) {
-                    first_read = 0;  // 첫 읽기 완료
-                    char broadcast_msg[BUFFER_SIZE];
-                    
-                    if (value == 0) {
-                        // 빛이 감지됨 (value == 0) → LED OFF
-                        if (g_libs.led_off) {
-                            g_libs.led_off();
-                            log_event("[CDS 모니터] 빛 감지됨 → LED OFF");
-                        }
-                        snprintf(broadcast_msg, sizeof(broadcast_msg), "CDS_SENSOR: LIGHT_DETECTED (LED OFF)\n");
-                    } else {
-                        // 빛이 없음 (value == 1) → LED ON
-                        if (g_libs.led_on) {
-                            g_libs.led_on();
-                            log_event("[CDS 모니터] 빛 없음 → LED ON");
-                        }
-                        snprintf(broadcast_msg, sizeof(broadcast_msg), "CDS_SENSOR: NO_LIGHT (LED ON)\n");
-                    }
-                    
-                    // 모든 연결된 클라이언트에 브로드캐스트
-                    broadcast_to_clients(broadcast_msg);
-                    
-                    last_value = value;
-                }
-            }
+}
+
+// 큐의 i번째(head 기준) 메시지
+static OutMessage **out_slot(OutputQueue *q, size_t i) {
+    return &q->msgs[(q->head + i) & (OUT_QUEUE_LEN - 1)];
+}
+
+// 버리거나 바꿀 수 있는 첫 메시지 위치: 송신 요청에 넘긴 메시지와 일부 전송된 head(버리면 프레임이 깨짐)는 유지
+static size_t out_first_unsent(const OutputQueue *q) {
+    if (q->sending > 0) return q->sending;
+    return (q->head_offset > 0) ? 1 : 0;
+}
+
+// 전송을 시작하지 않은 가장 오래된 이벤트 하나를 버림 (성공 시 0)
+static int out_drop_oldest_event(OutputQueue *q) {
+    size_t first = out_first_unsent(q);
+    for (size_t i = first; i < q->count; ++i) {
+        OutMessage *msg = *out_slot(q, i);
+        if (msg->kind == MSG_RESPONSE) continue;
+
+        out_message_release(msg);
+        for (size_t j = i; j + 1 < q->count; ++j) {
+            *out_slot(q, j) = *out_slot(q, j + 1);
         }
-        
-        // CDS_CHECK_INTERVAL 밀리초 대기
-        usleep(CDS_CHECK_INTERVAL * 1000);
+        q->count--;
+        q->dropped++;
+        atomic_fetch_add(&server_metrics.events_dropped, 1);
+        return 0;
     }
-    
-    // 스레드 종료 시 last_value 초기화 (재시작 시 정상 동작을 위해)
-    last_value = -1;
-    log_event("CDS 센서 모니터링 스레드 종료");
-    return NULL;
+    return -1;
 }
 
-// 7SEG 카운트다운 스레드: segment_display를 반복 호출하여 카운트다운 실행
-static void *segment_countdown_thread_func(void *arg)
-{
-    int start_number = *((int *)arg);
-    free(arg);  // 메모리 해제
-    
-    char log_msg[256];
-    snprintf(log_msg, sizeof(log_msg), "7SEG 카운트다운 스레드 시작: %d부터 시작", start_number);
-    log_event(log_msg);
-    
-    if (start_number < 0) start_number = 0;
-    if (start_number > 9) start_number = 9;
-    
-    // segment_display를 반복 호출하여 카운트다운
-    for (int n = start_number; n >= 0 && segment_countdown_running; --n) {
-        if (g_libs.segment_display) {
-            g_libs.segment_display(n);
-        }
-        
-        // 0이 되었을 때 부저 울림
-        if (n == 0) {
-            if (g_libs.buzzer_on) {
-                g_libs.buzzer_on();
-            }
-            usleep(500000);  // 0.5초 대기
-            if (g_libs.buzzer_off) {
-                g_libs.buzzer_off();
+// 송신 큐에 메시지 추가 (out_lock 잠금 전제, 성공 시 큐가 참조 1개를 가짐)
+// 반환값: 0 = 추가/병합됨, -1 = 정책상 연결 종료 필요
+static int out_push_locked(ClientContext *ctx, OutMessage *msg) {
+    OutputQueue *q = &ctx->out;
+
+    // 센서 이벤트 병합: 아직 전송을 시작하지 않은 센서 이벤트를 최신 값으로 교체
+    if (msg->kind == MSG_EVENT_SENSOR && slow_client_policy == SLOW_CLIENT_COALESCE) {
+        size_t first = out_first_unsent(q);
+        for (size_t i = first; i < q->count; ++i) {
+            OutMessage **slot = out_slot(q, i);
+            if ((*slot)->kind == MSG_EVENT_SENSOR) {
+                out_message_release(*slot);
+                atomic_fetch_add(&msg->refs, 1);
+                *slot = msg;
+                q->dropped++;
+                atomic_fetch_add(&server_metrics.events_dropped, 1);
+                return 0;
             }
-            break;  // 0에서 부저 울리고 종료
         }
-        
-        // 1초 대기 (스레드 중지 확인)
-        for (int i = 0; i < 10 && segment_countdown_running; ++i) {
-            usleep(100000);  // 0.1초씩 10번 체크 (총 1초)
-        }
-    }
-    
-    // 카운트다운 완료 알림
-    if (segment_countdown_running) {
-        broadcast_to_clients("SEGMENT_COUNTDOWN: COMPLETE\n");
-    } else {
-        broadcast_to_clients("SEGMENT_COUNTDOWN: STOPPED\n");
     }
-    
-    // 스레드 종료
-    pthread_mutex_lock(&segment_countdown_mutex);
-    segment_countdown_running = 0;
-    segment_thread_created = 0;
-    pthread_mutex_unlock(&segment_countdown_mutex);
-    
-    log_event("7SEG 카운트다운 스레드 종료");
-    return NULL;
-}
 
-// 퀴즈용 7SEG + 부저 카운트다운 스레드 (5초 제한)
-static void *quiz_thread_func(void *arg)
-{
-    (void)arg;
+    if (q->count == OUT_QUEUE_LEN) {
+        if (slow_client_policy == SLOW_CLIENT_DISCONNECT || out_drop_oldest_event(q) < 0) {
+            return -1;  // 응답만 가득 찬 경우(클라이언트가 읽지 않음)도 종료
+        }
+    }
 
-    pthread_mutex_lock(&quiz_mutex);
-    quiz_running = 1;
-    quiz_correct = 0;
-    pthread_mutex_unlock(&quiz_mutex);
+    atomic_fetch_add(&msg->refs, 1);
+    *out_slot(q, q->count) = msg;
+    q->count++;
+    return 0;
+}
 
-    int n = 5;
-    char log_msg[256];
-    snprintf(log_msg, sizeof(log_msg), "퀴즈 시작: %d초 카운트다운", n);
-    log_event(log_msg);
+// 송신 큐 앞쪽 메시지들을 iovec으로 (out_lock 잠금 전제), 반환값: iovec 수
+static int out_fill_iov_locked(OutputQueue *q, struct iovec *iov) {
+    int iovcnt = 0;
+    for (size_t i = 0; i < q->count && iovcnt < OUT_IOV_MAX; ++i) {
+        OutMessage *msg = *out_slot(q, i);
+        size_t skip = (i == 0) ? q->head_offset : 0;
+        iov[iovcnt].iov_base = msg->data + skip;
+        iov[iovcnt].iov_len = msg->len - skip;
+        iovcnt++;
+    }
+    return iovcnt;
+}
 
-    while (n >= 0) {
-        // 정답 맞춘 경우 즉시 종료
-        if (quiz_correct) {
+// 전송 완료된 sent 바이트만큼 메시지 해제 (out_lock 잠금 전제)
+static void out_consume_locked(OutputQueue *q, size_t sent) {
+    while (q->count > 0 && sent > 0) {
+        OutMessage **slot = out_slot(q, 0);
+        size_t left = (*slot)->len - q->head_offset;
+        if (sent < left) {
+            q->head_offset += sent;
             break;
         }
+        sent -= left;
+        out_message_release(*slot);
+        q->head = (q->head + 1) & (OUT_QUEUE_LEN - 1);
+        q->count--;
+        q->head_offset = 0;
+    }
+}
 
-        // 7SEG 표시
-        if (g_libs.segment_display) {
-            g_libs.segment_display(n);
-        }
+// 송신 큐를 소켓이 허용하는 만큼 writev로 전송 (논블로킹)
+// io_uring 송신 요청이 남아 있지 않을 때만 호출 (epoll 백엔드, 또는 reactors_pause로 링을 멈춘 뒤)
+// 반환값: 0 = 정상(남은 데이터가 있을 수 있음), -1 = 연결 오류
+static int flush_client(ClientContext *ctx) {
+    OutputQueue *q = &ctx->out;
+    int rc = 0;
 
-        // 부저 패턴: 5~3초는 warning, 2~1초는 emergency (각 0.2초)
-        struct timespec start_time, end_time;
-        clock_gettime(CLOCK_MONOTONIC, &start_time);
-        
-        if (n > 2) {
-            if (g_libs.buzzer_warning) {
-                g_libs.buzzer_warning();
-            } else if (g_libs.buzzer_on && g_libs.buzzer_off) {
-                g_libs.buzzer_on();
-                usleep(200000);
-                g_libs.buzzer_off();
-            }
-        } else if (n > 0) {
-            if (g_libs.buzzer_emergency) {
-                g_libs.buzzer_emergency();
-            } else if (g_libs.buzzer_on && g_libs.buzzer_off) {
-                g_libs.buzzer_on();
-                usleep(200000);
-                g_libs.buzzer_off();
-            }
-        }
+    pthread_mutex_lock(&ctx->out_lock);
+    while (q->count > 0) {
+        struct iovec iov[OUT_IOV_MAX];
+        int iovcnt = out_fill_iov_locked(q, iov);
 
-        if (quiz_correct) {
+        ssize_t sent = writev(ctx->socket_fd, iov, iovcnt);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) rc = -1;
             break;
         }
+        out_consume_locked(q, (size_t)sent);
+    }
+    pthread_mutex_unlock(&ctx->out_lock);
+    return rc;
+}
 
-        if (n == 0) {
-            // 0초에 fail 소리 (낮은 쿠쿵)
-            if (g_libs.buzzer_fail) {
-                g_libs.buzzer_fail();
-            } else if (g_libs.buzzer_on && g_libs.buzzer_off) {
-                g_libs.buzzer_on();
-                usleep(500000);
-                g_libs.buzzer_off();
-            }
-            break;
-        }
+// 모든 연결된 클라이언트에 메시지 브로드캐스트
+// 네트워크 I/O 없이 각 클라이언트 송신 큐에 메시지를 공유 참조로 넣기만 하고 I/O 루프를 깨움
+// 텍스트/바이너리 형식을 한 번씩만 만들어 연결의 프로토콜에 맞는 쪽을 넣음
+// 이벤트가 속한 주제 (0 = 구독과 무관하게 모든 연결에 전달)
+static unsigned int event_topic(ProtoEvent event) {
+    switch (event) {
+    case PROTO_EVT_CDS:                return PROTO_TOPIC_SENSOR;
+    case PROTO_EVT_COUNTDOWN_COMPLETE:
+    case PROTO_EVT_COUNTDOWN_STOPPED:  return PROTO_TOPIC_COUNTDOWN;
+    case PROTO_EVT_QUIZ_TIMEOVER:      return PROTO_TOPIC_QUIZ;
+    case PROTO_EVT_BUZZER_DONE:        return PROTO_TOPIC_BUZZER;
+    default:                           return 0;
+    }
+}
 
-        // 부저 소리 시간 측정 후 나머지 시간만큼만 대기 (정확히 1초)
-        clock_gettime(CLOCK_MONOTONIC, &end_time);
-        long elapsed_ns = (end_time.tv_sec - start_time.tv_sec) * 1000000000L + 
-                         (end_time.tv_nsec - start_time.tv_nsec);
-        long elapsed_us = elapsed_ns / 1000;
-        long remaining_us = 1000000 - elapsed_us;  // 1초(1000000us) - 경과 시간
-        
-        if (remaining_us > 0) {
-            usleep(remaining_us);
-        }
-        n--;
-    }
-
-    if (quiz_correct) {
-        // 정답: success 멜로디 (딩동댕)
-        if (g_libs.buzzer_success) {
-            g_libs.buzzer_success();
-        } else if (g_libs.buzzer_on && g_libs.buzzer_off) {
-            // fallback 간단 패턴
-            for (int i = 0; i < 2; ++i) {
-                g_libs.buzzer_on();
-                usleep(200000);
-                g_libs.buzzer_off();
-                usleep(100000);
-            }
-            g_libs.buzzer_on();
-            usleep(500000);
-            g_libs.buzzer_off();
-        }
-        //broadcast_to_clients("QUIZ RESULT: CORRECT\n");
-    } else {
-        // 시간 초과: 폭탄 소리 후 즉시 메시지 전송 (클라이언트에서 0.2초 대기)
-        broadcast_to_clients("QUIZ RESULT: TIMEOVER\n");
+static void broadcast_event(const char *message, MessageKind kind, ProtoEvent event, int value) {
+    if (!message) return;
+    if ((int)event < EVENT_KIND_COUNT) {
+        atomic_fetch_add_explicit(&server_metrics.events[event], 1, memory_order_relaxed);
     }
 
-    pthread_mutex_lock(&quiz_mutex);
-    quiz_running = 0;
-    pthread_mutex_unlock(&quiz_mutex);
+    // 구독한 연결이 하나도 없으면 메시지를 만들지도 않음
+    unsigned int topic = event_topic(event);
+    if (topic && atomic_load(&client_registry.topic_subscribers[__builtin_ctz(topic)]) == 0) {
+        return;
+    }
+    uint64_t start_ns = metrics_now_ns();
 
-    log_event("퀴즈 카운트다운 스레드 종료");
-    return NULL;
-}
+    uint8_t frame[PROTO_FRAME_SIZE];
+    proto_pack(frame, PROTO_OP_EVENT, (uint8_t)event, 0, value);
 
-int main(int argc, char *argv[]) {
-    (void)argc;  // 사용하지 않는 매개변수 경고 제거
-    (void)argv;
+    OutMessage *text_msg = out_message_new(kind, message, strlen(message));
+    OutMessage *bin_msg = out_message_new(kind, (const char *)frame, sizeof(frame));
+    if (!text_msg || !bin_msg) {
+        if (text_msg) out_message_release(text_msg);
+        if (bin_msg) out_message_release(bin_msg);
+        return;
+    }
 
-    // 데몬 프로세스로 전환하기 전에 실행 파일 경로를 먼저 얻어야 함
-    // (daemon() 호출 후에는 작업 디렉토리가 "/"로 변경됨)
-    char *exe_dir = get_exe_directory();
-    if (!exe_dir) {
-        // 데몬 전환 전이므로 stderr에 출력
-        fprintf(stderr, "실행 파일 디렉토리를 찾을 수 없습니다.\n");
-        return 1;
+    // 레지스트리 잠금은 스냅샷을 뜨는 동안만 유지 (송신 큐 잠금과 겹치지 않음)
+    ClientContext *snapshot[SNAPSHOT_STACK];
+    ClientContext **clients = client_registry.capacity <= SNAPSHOT_STACK
+        ? snapshot : malloc(sizeof(ClientContext *) * client_registry.capacity);
+    if (!clients) {
+        out_message_release(text_msg);
+        out_message_release(bin_msg);
+        return;
+    }
+
+    int n = client_registry_snapshot(clients);
+    for (int i = 0; i < n; ++i) {
+        ClientContext *ctx = clients[i];
+        // 구독하지 않은 연결은 송신 큐 잠금도 잡지 않음 (비트 검사 한 번)
+        if (topic && !(atomic_load_explicit(&ctx->topics, memory_order_relaxed) & topic)) {
+            client_release(ctx);
+            continue;
+        }
+        pthread_mutex_lock(&ctx->out_lock);
+        if (out_push_locked(ctx, ctx->binary ? bin_msg : text_msg) < 0) {
+            atomic_store(&ctx->doomed, 1);  // I/O 루프가 연결 종료
+        }
+        pthread_mutex_unlock(&ctx->out_lock);
+        client_release(ctx);
+    }
+    if (clients != snapshot) free(clients);
+
+    out_message_release(text_msg);
+    out_message_release(bin_msg);
+    wake_reactors();
+    latency_record_since(&server_metrics.broadcasts, start_ns);
+}
+
+static void broadcast_to_clients(const char *message, ProtoEvent event) {
+    broadcast_event(message, MSG_EVENT, event, 0);
+}
+
+// ===== 부저 액추에이터 연동 =====
+
+// 액추에이터 스레드가 장치 라이브러리 표를 쓰는 구간 표시: 들어갈 때와 나올 때 1씩 증가 (홀수 = 사용 중)
+// 표를 교체한 뒤 이 값이 짝수였거나 바뀌었으면 액추에이터는 이전 표를 더 이상 보지 않음 (정지 상태 통과)
+static atomic_ulong libs_reader_epoch = 0;
+
+// 액추에이터 스레드의 주파수 설정 (buzzer_tone 미지원 라이브러리는 기본음 on/off로 대체)
+// 같은 주파수가 이어지는 단계(패턴 연결, 반복 BUZZER_ON 등)는 하드웨어에 다시 쓰지 않음
+static void buzzer_tone_write(int freq) {
+    if (atomic_load(&device_state.buzzer_freq) == freq) {
+        atomic_fetch_add(&device_state.skipped, 1);
+        return;
+    }
+
+    atomic_fetch_add(&libs_reader_epoch, 1);
+    DeviceLibs *libs = device_libs();
+    int ret;
+    DeviceCall call;
+    uint64_t start_ns = metrics_now_ns();
+    if (libs->buzzer_tone) {
+        ret = libs->buzzer_tone(freq);
+        call = DEVICE_CALL_BUZZER_TONE;
+    } else if (freq > 0) {
+        ret = libs->buzzer_on();
+        call = DEVICE_CALL_BUZZER_ON;
+    } else {
+        ret = libs->buzzer_off();
+        call = DEVICE_CALL_BUZZER_OFF;
+    }
+    atomic_fetch_add(&libs_reader_epoch, 1);
+    latency_record_since(&server_metrics.device_calls[call], start_ns);
+    atomic_store(&device_state.buzzer_freq, ret < 0 ? DEVICE_STATE_UNKNOWN : freq);
+    atomic_fetch_add(&device_state.writes, 1);
+}
+
+// ===== 장치 상태 캐시를 거친 쓰기 (I/O 루프 스레드 전용) =====
+// 실제로 하드웨어에 쓴 경우에만 결과 상태를 저널에 기록 (원인은 journal_origin)
+
+// 지금 실행 중인 장치 쓰기의 원인: 명령 핸들러 실행 중에는 그 명령, 그 외(타이머/센서)는 이벤트
+typedef struct JournalOrigin {
+    JournalSource source;
+    uint8_t opcode;
+    int32_t arg;
+} JournalOrigin;
+
+static JournalOrigin journal_origin = { JOURNAL_SRC_EVENT, 0, 0 };
+
+static void journal_device_state(void) {
+    journal_append(journal_origin.source, journal_origin.opcode, journal_origin.arg,
+                   device_state.led_level, device_state.segment_digit);
+}
+
+// LED 밝기 설정 (0 = 꺼짐, LED_LEVEL_MAX = 켜짐), 캐시와 같으면 생략
+static int device_led_set(int level, int via_brightness) {
+    if (device_state.led_level == level) {
+        atomic_fetch_add(&device_state.skipped, 1);
+        return 0;
+    }
+
+    DeviceLibs *libs = device_libs();
+    int ret;
+    DeviceCall call;
+    uint64_t start_ns = metrics_now_ns();
+    if (level == 0) {
+        ret = libs->led_off();
+        call = DEVICE_CALL_LED_OFF;
+    } else if (level == LED_LEVEL_MAX && !via_brightness) {
+        ret = libs->led_on();
+        call = DEVICE_CALL_LED_ON;
+    } else {
+        ret = libs->led_set_brightness ? libs->led_set_brightness(level) : -1;
+        call = DEVICE_CALL_LED_SET_BRIGHTNESS;
+    }
+    latency_record_since(&server_metrics.device_calls[call], start_ns);
+    device_state.led_level = ret < 0 ? DEVICE_STATE_UNKNOWN : level;
+    atomic_fetch_add(&device_state.writes, 1);
+    journal_device_state();
+    return ret;
+}
+
+// 7세그먼트 숫자 표시, 캐시와 같으면 생략
+static int device_segment_set(int digit) {
+    if (device_state.segment_digit == digit) {
+        atomic_fetch_add(&device_state.skipped, 1);
+        return 0;
+    }
+
+    uint64_t start_ns = metrics_now_ns();
+    int ret = device_libs()->segment_display(digit);
+    latency_record_since(&server_metrics.device_calls[DEVICE_CALL_SEGMENT_DISPLAY], start_ns);
+    device_state.segment_digit = ret < 0 ? DEVICE_STATE_UNKNOWN : digit;
+    atomic_fetch_add(&device_state.writes, 1);
+    journal_device_state();
+    return ret;
+}
+
+// BUZZER_PATTERN/BUZZER_PLAY 작업 종료 알림
+static void buzzer_pattern_done(unsigned int job_id, int pattern, ActuatorResult result) {
+    char msg[128];
+    snprintf(msg, sizeof(msg), "BUZZER_DONE: %u %s %s\n", job_id, actuator_pattern_name(pattern),
+             result == ACTUATOR_COMPLETE ? "COMPLETE" : "PREEMPTED");
+    broadcast_event(msg, MSG_EVENT, PROTO_EVT_BUZZER_DONE, (int)job_id);
+}
+
+// ===== 명령 디스패치 테이블 =====
+// 명령 동사(verb) → 핸들러 매핑. 새 장치 명령은 command_table에 항목만 추가하면 된다.
+
+// 명령 인자 (동사 뒤의 문자열과 정수 파싱 결과)
+typedef struct CommandArgs {
+    const char *text;  // 동사 뒤 공백을 건너뛴 인자 문자열 (없으면 "")
+    int value;         // 정수 인자 값
+    int has_value;     // 정수 인자가 올바르게 파싱되었는지 여부
+    ClientContext *client;  // 명령을 보낸 연결 (구독 등 연결별 상태용)
+} CommandArgs;
+
+// 명령 처리 결과: 텍스트 연결에는 text를, 바이너리 연결에는 status/value를 보냄
+typedef struct CommandReply {
+    ProtoStatus status;
+    int value;
+    const char *text;
+} CommandReply;
+
+#define REPLY(status, text) ((CommandReply){ (status), 0, (text) })
+#define REPLY_VALUE(status, value, text) ((CommandReply){ (status), (value), (text) })
+
+typedef CommandReply (*command_handler_t)(DeviceLibs *libs, const CommandArgs *args);
+
+// 인자만 검사하고 아무것도 실행하지 않음 (BATCH가 실행 전에 모든 명령을 확인할 때 사용, 핸들러도 먼저 호출)
+// 인자가 올바르면 CHECK_OK, 아니면 핸들러가 보낼 실패 응답 그대로
+typedef CommandReply (*command_check_t)(const CommandArgs *args);
+#define CHECK_OK REPLY(PROTO_ST_OK, NULL)
+
+typedef struct CommandEntry {
+    const char *verb;
+    ProtoOpcode opcode;  // 바이너리 프로토콜 명령 코드
+    command_handler_t handler;
+    command_check_t check;  // 인자가 없어 검사할 것이 없으면 NULL
+} CommandEntry;
+
+static CommandReply cmd_led_on(DeviceLibs *libs, const CommandArgs *args) {
+    (void)libs;
+    (void)args;
+    device_led_set(LED_LEVEL_MAX, 0);
+    return REPLY(PROTO_ST_OK, "LED ON OK\n");
+}
+
+static CommandReply cmd_led_off(DeviceLibs *libs, const CommandArgs *args) {
+    (void)libs;
+    (void)args;
+    device_led_set(0, 0);
+    return REPLY(PROTO_ST_OK, "LED OFF OK\n");
+}
+
+static CommandReply check_led_brightness(const CommandArgs *args) {
+    if (!args->has_value || args->value < 1 || args->value > LED_LEVEL_MAX) {
+        return REPLY(PROTO_ST_BAD_ARG, "LED BRIGHTNESS FAILED (범위: 1-3)\n");
+    }
+    return CHECK_OK;
+}
+
+static CommandReply cmd_led_brightness(DeviceLibs *libs, const CommandArgs *args) {
+    (void)libs;
+    CommandReply bad = check_led_brightness(args);
+    if (bad.status != PROTO_ST_OK) return bad;
+    device_led_set(args->value, 1);
+    return REPLY(PROTO_ST_OK, "LED BRIGHTNESS OK\n");
+}
+
+// 부저는 액추에이터 스레드만 직접 제어 (재생 중인 패턴을 선점하고 연속음/무음 유지)
+static CommandReply cmd_buzzer_on(DeviceLibs *libs, const CommandArgs *args) {
+    (void)libs;
+    (void)args;
+    actuator_hold(BUZZER_DEFAULT_FREQ);
+    return REPLY(PROTO_ST_OK, "BUZZER ON OK\n");
+}
+
+static CommandReply cmd_buzzer_off(DeviceLibs *libs, const CommandArgs *args) {
+    (void)libs;
+    (void)args;
+    actuator_hold(0);
+    return REPLY(PROTO_ST_OK, "BUZZER OFF OK\n");
+}
+
+// 부저 패턴 재생 (번호 또는 이름): 즉시 작업 번호로 응답하고, 끝나면 BUZZER_DONE 이벤트 브로드캐스트
+static CommandReply check_buzzer_pattern(const CommandArgs *args) {
+    int pattern = args->has_value ? args->value : actuator_find_pattern(args->text);
+    if (!actuator_pattern_name(pattern) || pattern == BUZZER_PATTERN_CUSTOM) {
+        return REPLY(PROTO_ST_BAD_ARG, "BUZZER PATTERN FAILED (알 수 없는 패턴)\n");
+    }
+    return CHECK_OK;
+}
+
+static CommandReply cmd_buzzer_pattern(DeviceLibs *libs, const CommandArgs *args) {
+    static char reply_text[64];  // I/O 루프 스레드에서만 호출됨
+    (void)libs;
+
+    CommandReply bad = check_buzzer_pattern(args);
+    if (bad.status != PROTO_ST_OK) return bad;
+    int pattern = args->has_value ? args->value : actuator_find_pattern(args->text);
+    unsigned int job_id = actuator_play(pattern, 1);
+    if (job_id == 0) {
+        return REPLY(PROTO_ST_BUSY, "BUZZER PATTERN BUSY\n");
+    }
+    snprintf(reply_text, sizeof(reply_text), "BUZZER PATTERN OK %u\n", job_id);
+    return REPLY_VALUE(PROTO_ST_OK, (int)job_id, reply_text);
+}
+
+// 클라이언트가 보낸 음 목록 재생: "BUZZER_PLAY 주파수:길이ms,..." (재생 중인 패턴 선점)
+static CommandReply check_buzzer_play(const CommandArgs *args) {
+    ToneStep steps[ACTUATOR_MAX_STEPS];
+    if (actuator_parse_steps(args->text, steps, ACTUATOR_MAX_STEPS) < 0) {
+        return REPLY(PROTO_ST_BAD_ARG, "BUZZER PLAY FAILED (형식: 주파수:길이ms,... 최대 32개)\n");
+    }
+    return CHECK_OK;
+}
+
+static CommandReply cmd_buzzer_play(DeviceLibs *libs, const CommandArgs *args) {
+    static char reply_text[64];
+    ToneStep steps[ACTUATOR_MAX_STEPS];
+    (void)libs;
+
+    int count = actuator_parse_steps(args->text, steps, ACTUATOR_MAX_STEPS);
+    if (count < 0) {
+        return check_buzzer_play(args);
+    }
+    unsigned int job_id = actuator_play_steps(steps, count, 1);
+    if (job_id == 0) {
+        return REPLY(PROTO_ST_FAILED, "BUZZER PLAY FAILED\n");
+    }
+    snprintf(reply_text, sizeof(reply_text), "BUZZER PLAY OK %u\n", job_id);
+    return REPLY_VALUE(PROTO_ST_OK, (int)job_id, reply_text);
+}
+
+// 음 시작 시각 지터 통계
+static CommandReply cmd_buzzer_stats(DeviceLibs *libs, const CommandArgs *args) {
+    static char reply_text[256];
+    ActuatorStats stats;
+    (void)libs;
+    (void)args;
+
+    actuator_get_stats(&stats);
+    snprintf(reply_text, sizeof(reply_text),
+             "BUZZER STATS steps=%lu avg_jitter_us=%ld max_jitter_us=%ld last_jitter_us=%ld "
+             "late_over_1ms=%lu merged=%lu preempted=%lu\n",
+             stats.steps, stats.avg_jitter_us, stats.max_jitter_us, stats.last_jitter_us,
+             stats.late_over_1ms, stats.merged, stats.preempted);
+    return REPLY_VALUE(PROTO_ST_OK, (int)stats.max_jitter_us, reply_text);
+}
+
+static CommandReply check_segment_display(const CommandArgs *args) {
+    if (!args->has_value || args->value < 0 || args->value > 9) {
+        return REPLY(PROTO_ST_BAD_ARG, "SEGMENT DISPLAY FAILED (범위: 0-9)\n");
+    }
+    return CHECK_OK;
+}
+
+static CommandReply cmd_segment_display(DeviceLibs *libs, const CommandArgs *args) {
+    // 입력한 숫자를 그냥 표시만 함 (즉시 처리)
+    CommandReply bad = check_segment_display(args);
+    if (bad.status != PROTO_ST_OK) return bad;
+    (void)libs;
+    device_segment_set(args->value);
+    return REPLY(PROTO_ST_OK, "SEGMENT DISPLAY OK\n");
+}
+
+static CommandReply check_segment_countdown(const CommandArgs *args) {
+    if (!args->has_value || args->value < 0 || args->value > 9) {
+        return REPLY(PROTO_ST_BAD_ARG, "SEGMENT COUNTDOWN FAILED (범위: 0-9)\n");
+    }
+    return CHECK_OK;
+}
+
+static CommandReply cmd_segment_countdown(DeviceLibs *libs, const CommandArgs *args) {
+    (void)libs;
+    // 입력한 숫자부터 카운트다운 시작
+    int number = args->value;
+    CommandReply bad = check_segment_countdown(args);
+    if (bad.status != PROTO_ST_OK) return bad;
+    if (timer_pending(&segment_countdown_task)) {
+        return REPLY(PROTO_ST_BUSY, "SEGMENT COUNTDOWN ALREADY RUNNING\n");
+    }
+
+    // 첫 숫자는 바로 표시하고 이후 1초 간격으로 감소
+    segment_countdown_value = number;
+    if (timer_schedule(&segment_countdown_task, 0) < 0) {
+        return REPLY(PROTO_ST_FAILED, "SEGMENT COUNTDOWN FAILED\n");
+    }
+
+    char log_msg[256];
+    snprintf(log_msg, sizeof(log_msg), "7SEG 카운트다운 시작: %d부터 시작", number);
+    log_event(log_msg);
+    return REPLY(PROTO_ST_OK, "SEGMENT COUNTDOWN OK\n");
+}
+
+static CommandReply cmd_segment_stop(DeviceLibs *libs, const CommandArgs *args) {
+    (void)libs;
+    (void)args;
+    // 7SEG 카운트다운 중지: 예약된 다음 틱을 취소하므로 즉시 멈춤
+    if (!timer_pending(&segment_countdown_task)) {
+        return REPLY(PROTO_ST_NOT_RUNNING, "SEGMENT NOT RUNNING\n");
+    }
+    timer_cancel(&segment_countdown_task);
+    broadcast_to_clients("SEGMENT_COUNTDOWN: STOPPED\n", PROTO_EVT_COUNTDOWN_STOPPED);
+    log_event("7SEG 카운트다운 중지");
+    return REPLY(PROTO_ST_OK, "SEGMENT STOP OK\n");
+}
+
+static CommandReply cmd_quiz_start(DeviceLibs *libs, const CommandArgs *args) {
+    (void)libs;
+    (void)args;
+    // 퀴즈 시작: 5초 카운트다운 + 부저
+    if (quiz_running) {
+        return REPLY(PROTO_ST_BUSY, "QUIZ ALREADY RUNNING\n");
+    }
+    quiz_remaining = 5;
+    if (timer_schedule(&quiz_task, 0) < 0) {
+        return REPLY(PROTO_ST_FAILED, "QUIZ START FAILED\n");
+    }
+    quiz_running = 1;
+
+    char log_msg[256];
+    snprintf(log_msg, sizeof(log_msg), "퀴즈 시작: %d초 카운트다운", quiz_remaining);
+    log_event(log_msg);
+    return REPLY(PROTO_ST_OK, "QUIZ START: 이 프로젝트의 점수는? (5초 안에 100을 입력하세요!)\n");
+}
+
+static CommandReply cmd_quiz_answer(DeviceLibs *libs, const CommandArgs *args) {
+    (void)libs;
+    // 사용자가 입력한 정답 확인
+    if (!quiz_running) {
+        return REPLY(PROTO_ST_NOT_RUNNING, "QUIZ NOT RUNNING\n");
+    }
+
+    if (args->has_value && args->value == 100) {
+        // 정답: 남은 카운트다운을 취소하고 success 멜로디 (재생 중인 카운트다운 경고음은 선점)
+        timer_cancel(&quiz_task);
+        quiz_running = 0;
+        actuator_play(BUZZER_PATTERN_SUCCESS, 0);
+        log_event("퀴즈 종료: 정답");
+        return REPLY_VALUE(PROTO_ST_OK, 1, "QUIZ CORRECT: 정답입니다!\n");
+    } else {
+        // 오답: warning 패턴 1회 (비동기 재생, 연속 오답은 재생 중인 패턴에 병합)
+        actuator_play(BUZZER_PATTERN_WARNING, 0);
+        return REPLY_VALUE(PROTO_ST_OK, 0, "QUIZ WRONG: 다시 입력하세요\n");
+    }
+}
+
+static CommandReply cmd_sensor_on(DeviceLibs *libs, const CommandArgs *args) {
+    (void)args;
+    // CDS 센서 모니터링 시작
+    if (!libs->sensor_init || !libs->sensor_get_value) {
+        return REPLY(PROTO_ST_UNAVAILABLE, "SENSOR LIBRARY NOT AVAILABLE\n");
+    }
+    if (cds_monitor_running) {
+        return REPLY(PROTO_ST_BUSY, "SENSOR ALREADY ON\n");
+    }
+    if (cds_monitor_start(-1) < 0) {
+        return REPLY(PROTO_ST_FAILED, "SENSOR ON FAILED\n");
+    }
+    return REPLY(PROTO_ST_OK, "SENSOR ON OK\n");
+}
+
+static CommandReply cmd_sensor_off(DeviceLibs *libs, const CommandArgs *args) {
+    (void)libs;
+    (void)args;
+    if (!cds_monitor_running) {
+        return REPLY(PROTO_ST_NOT_RUNNING, "SENSOR ALREADY OFF\n");
+    }
+    cds_monitor_stop();
+    return REPLY(PROTO_ST_OK, "SENSOR OFF OK\n");
+}
+
+// 센서 최신 샘플 조회: 모니터링이 게시한 값을 그대로 반환 (sensor_get_value 호출 없음)
+static CommandReply cmd_sensor_read(DeviceLibs *libs, const CommandArgs *args) {
+    static char reply_text[160];
+    SensorSample sample;
+    struct timespec now;
+    (void)libs;
+    (void)args;
+
+    if (sensor_read(&sample) < 0) {
+        return REPLY(PROTO_ST_NOT_RUNNING, "SENSOR READ NO DATA (SENSOR_ON 필요)\n");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t now_ns = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+    snprintf(reply_text, sizeof(reply_text),
+             "SENSOR READ value=%d stable=%d age_ms=%llu seq=%llu changes=%llu monitor=%s\n",
+             sample.value, sensor_filter_stable(), (unsigned long long)sensor_age_ms(&sample, now_ns),
+             (unsigned long long)sample.seq, (unsigned long long)sample.changes,
+             cds_monitor_running ? "on" : "off");
+    return REPLY_VALUE(PROTO_ST_OK, sample.value, reply_text);
+}
+
+// "debounce_ms=N vote=N hold_ms=N" 형식의 필터 설정 파싱 (빠진 항목은 config의 기존 값 유지)
+// 반환값: 0 = 성공, -1 = 형식 오류
+static int parse_filter_config(const char *text, SensorFilterConfig *config) {
+    char buf[128];
+    char *save = NULL;
+    snprintf(buf, sizeof(buf), "%s", text);
+
+    for (char *tok = strtok_r(buf, " \t\r\n", &save); tok; tok = strtok_r(NULL, " \t\r\n", &save)) {
+        char *end;
+        char *eq = strchr(tok, '=');
+        if (!eq) return -1;
+        *eq = '\0';
+        long value = strtol(eq + 1, &end, 10);
+        if (end == eq + 1 || *end != '\0' || value < INT_MIN || value > INT_MAX) return -1;
+
+        if (strcmp(tok, "debounce_ms") == 0) {
+            config->debounce_ms = (int)value;
+        } else if (strcmp(tok, "vote") == 0) {
+            config->vote_n = (int)value;
+        } else if (strcmp(tok, "hold_ms") == 0) {
+            config->hold_ms = (int)value;
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 센서 이력 조회 (I/O 루프의 메모리만 읽음)
+// "SENSOR_HISTORY <since_seq>" → seq가 since_seq보다 큰 변화 이력 (한 번에 최대 SENSOR_HISTORY_REPLY_MAX개)
+// "SENSOR_HISTORY MINUTES [N]" → 최근 N분(기본 10, 최대 60)의 분 단위 켜짐 비율
+#define SENSOR_HISTORY_REPLY_MAX 32
+#define SENSOR_HISTORY_USAGE "SENSOR HISTORY FAILED (형식: SENSOR_HISTORY <since_seq> | MINUTES [N])\n"
+
+// "MINUTES [N]" 인자: 반환값 = 조회할 분 수 (N 생략 시 10, 최대 SENSOR_MINUTES_LEN),
+// MINUTES 형식이 아니면 0, N이 올바르지 않으면 -1
+static int parse_history_minutes(const char *text) {
+    if (strncmp(text, "MINUTES", 7) != 0 || (text[7] != '\0' && text[7] != ' ')) {
+        return 0;
+    }
+    const char *arg = text + 7;
+    while (*arg == ' ') arg++;
+    if (*arg == '\0') {
+        return 10;
+    }
+    char *end;
+    errno = 0;
+    long value = strtol(arg, &end, 10);
+    while (*end == ' ') end++;
+    if (end == arg || *end != '\0' || errno != 0 || value < 1) {
+        return -1;
+    }
+    return value > SENSOR_MINUTES_LEN ? SENSOR_MINUTES_LEN : (int)value;
+}
+
+static CommandReply check_sensor_history(const CommandArgs *args) {
+    int minutes = parse_history_minutes(args->text);
+    if (minutes < 0 || (minutes == 0 && args->text[0] != '\0' && (!args->has_value || args->value < 0))) {
+        return REPLY(PROTO_ST_BAD_ARG, SENSOR_HISTORY_USAGE);
+    }
+    return CHECK_OK;
+}
+
+static CommandReply cmd_sensor_history(DeviceLibs *libs, const CommandArgs *args) {
+    static char reply_text[2048];
+    (void)libs;
+
+    CommandReply bad = check_sensor_history(args);
+    if (bad.status != PROTO_ST_OK) return bad;
+
+    int want = parse_history_minutes(args->text);
+    if (want > 0) {
+        SensorMinute buckets[SENSOR_MINUTES_LEN];
+        int n = sensor_history_minutes(buckets, want);
+        int len = snprintf(reply_text, sizeof(reply_text), "SENSOR MINUTES n=%d", n);
+        for (int i = 0; i < n && len < (int)sizeof(reply_text); ++i) {
+            // 분 시작 시각(epoch 초):켜짐 비율(천분율):관측 ms:변화 수
+            len += snprintf(reply_text + len, sizeof(reply_text) - len, " %llu:%u:%u:%u",
+                            (unsigned long long)(buckets[i].minute * 60),
+                            buckets[i].on_ms * 1000U / buckets[i].observed_ms,
+                            buckets[i].observed_ms, buckets[i].transitions);
+        }
+        if (len < (int)sizeof(reply_text)) snprintf(reply_text + len, sizeof(reply_text) - len, "\n");
+        return REPLY_VALUE(PROTO_ST_OK, n, reply_text);
+    }
+
+    SensorHistoryEntry entries[SENSOR_HISTORY_REPLY_MAX];
+    int remaining = 0;
+    int n = sensor_history_since((uint64_t)(args->has_value ? args->value : 0), entries,
+                                 SENSOR_HISTORY_REPLY_MAX, &remaining);
+
+    int len = snprintf(reply_text, sizeof(reply_text), "SENSOR HISTORY n=%d more=%d", n, remaining);
+    for (int i = 0; i < n && len < (int)sizeof(reply_text); ++i) {
+        // seq:값:epoch ms
+        len += snprintf(reply_text + len, sizeof(reply_text) - len, " %llu:%d:%llu",
+                        (unsigned long long)entries[i].seq, entries[i].value,
+                        (unsigned long long)entries[i].time_ms);
+    }
+    if (len < (int)sizeof(reply_text)) snprintf(reply_text + len, sizeof(reply_text) - len, "\n");
+    return REPLY_VALUE(PROTO_ST_OK, n + remaining, reply_text);
+}
+
+// 센서 필터 설정/통계: "SENSOR_FILTER [debounce_ms=N] [vote=N] [hold_ms=N]" (인자 없으면 조회만)
+// 빠진 항목은 현재 설정 값으로 채워 범위 검사 (항목마다 범위가 따로여서 BATCH의 앞선 SENSOR_FILTER와 무관)
+static CommandReply check_sensor_filter(const CommandArgs *args) {
+    SensorFilterConfig config;
+    sensor_filter_get_config(&config);
+    if (args->text[0] == '\0') {
+        return CHECK_OK;
+    }
+    if (parse_filter_config(args->text, &config) < 0) {
+        return REPLY(PROTO_ST_INVALID, "SENSOR FILTER FAILED (형식: debounce_ms=N vote=N hold_ms=N)\n");
+    }
+    if (!sensor_filter_valid(&config)) {
+        return REPLY(PROTO_ST_BAD_ARG, "SENSOR FILTER FAILED (범위: debounce_ms/hold_ms 0-60000, vote 1-15)\n");
+    }
+    return CHECK_OK;
+}
+
+static CommandReply cmd_sensor_filter(DeviceLibs *libs, const CommandArgs *args) {
+    static char reply_text[256];
+    SensorFilterConfig config;
+    SensorFilterStats stats;
+    (void)libs;
+
+    CommandReply bad = check_sensor_filter(args);
+    if (bad.status != PROTO_ST_OK) return bad;
+    sensor_filter_get_config(&config);
+    if (args->text[0] != '\0') {
+        parse_filter_config(args->text, &config);
+        sensor_filter_configure(&config);
+    }
+
+    sensor_filter_get_stats(&stats);
+    snprintf(reply_text, sizeof(reply_text),
+             "SENSOR FILTER debounce_ms=%d vote=%d hold_ms=%d samples=%lu accepted=%lu "
+             "vote_suppressed=%lu debounce_suppressed=%lu hold_deferred=%lu\n",
+             config.debounce_ms, config.vote_n, config.hold_ms, stats.samples, stats.accepted,
+             stats.vote_suppressed, stats.debounce_suppressed, stats.hold_deferred);
+    return REPLY_VALUE(PROTO_ST_OK, (int)(stats.vote_suppressed + stats.debounce_suppressed), reply_text);
+}
+
+// ===== 이벤트 구독 =====
+static const char *const topic_names[PROTO_TOPIC_COUNT] = { "sensor", "countdown", "quiz", "buzzer" };
+
+// 주제 목록 파싱: 정수 비트 마스크 또는 "sensor,quiz" / "sensor quiz" / "all", 반환값: 마스크 (형식 오류 = -1)
+static int parse_topics(const CommandArgs *args) {
+    if (args->has_value) {
+        return (args->value & ~PROTO_TOPIC_ALL) ? -1 : args->value;
+    }
+
+    char buf[128];
+    char *save = NULL;
+    int mask = 0;
+    snprintf(buf, sizeof(buf), "%s", args->text);
+    for (char *tok = strtok_r(buf, " ,\t\r\n", &save); tok; tok = strtok_r(NULL, " ,\t\r\n", &save)) {
+        int found = 0;
+        if (strcmp(tok, "all") == 0) {
+            mask |= PROTO_TOPIC_ALL;
+            continue;
+        }
+        for (int i = 0; i < PROTO_TOPIC_COUNT; ++i) {
+            if (strcmp(tok, topic_names[i]) == 0) {
+                mask |= 1 << i;
+                found = 1;
+                break;
+            }
+        }
+        if (!found) return -1;
+    }
+    return mask ? mask : -1;
+}
+
+// "SUBSCRIBE OK sensor,quiz" 형식 응답 (I/O 루프 스레드에서만 호출)
+static CommandReply topics_reply(const char *verb, unsigned int topics) {
+    static char reply_text[128];
+    int len = snprintf(reply_text, sizeof(reply_text), "%s OK ", verb);
+    const char *sep = "";
+    for (int i = 0; i < PROTO_TOPIC_COUNT; ++i) {
+        if (topics & (1u << i)) {
+            len += snprintf(reply_text + len, sizeof(reply_text) - len, "%s%s", sep, topic_names[i]);
+            sep = ",";
+        }
+    }
+    snprintf(reply_text + len, sizeof(reply_text) - len, "%s\n", topics ? "" : "none");
+    return REPLY_VALUE(PROTO_ST_OK, (int)topics, reply_text);
+}
+
+static CommandReply check_subscribe(const CommandArgs *args) {
+    if (parse_topics(args) < 0) {
+        return REPLY(PROTO_ST_BAD_ARG, "SUBSCRIBE FAILED (주제: sensor, countdown, quiz, buzzer, all)\n");
+    }
+    return CHECK_OK;
+}
+
+static CommandReply check_unsubscribe(const CommandArgs *args) {
+    if (parse_topics(args) < 0) {
+        return REPLY(PROTO_ST_BAD_ARG, "UNSUBSCRIBE FAILED (주제: sensor, countdown, quiz, buzzer, all)\n");
+    }
+    return CHECK_OK;
+}
+
+static CommandReply cmd_subscribe(DeviceLibs *libs, const CommandArgs *args) {
+    (void)libs;
+    int mask = parse_topics(args);
+    if (mask < 0) {
+        return check_subscribe(args);
+    }
+    unsigned int topics = atomic_load(&args->client->topics) | (unsigned int)mask;
+    client_set_topics(args->client, topics);
+    return topics_reply("SUBSCRIBE", topics);
+}
+
+static CommandReply cmd_unsubscribe(DeviceLibs *libs, const CommandArgs *args) {
+    (void)libs;
+    int mask = parse_topics(args);
+    if (mask < 0) {
+        return check_unsubscribe(args);
+    }
+    unsigned int topics = atomic_load(&args->client->topics) & ~(unsigned int)mask;
+    client_set_topics(args->client, topics);
+    return topics_reply("UNSUBSCRIBE", topics);
+}
+
+static CommandReply run_batch(DeviceLibs *libs, ClientContext *client, char *const ops[], int count);
+
+// 여러 명령을 한 번에 실행: "BATCH 명령; 명령; ..."은 바로 실행하고,
+// 인자 없이 "BATCH"만 보내면 END 줄까지 받은 명령을 모아 실행 (시작 응답 없이 END에서 한 번만 응답)
+static CommandReply cmd_batch(DeviceLibs *libs, const CommandArgs *args) {
+    if (args->text[0] == '\0') {
+        ClientContext *ctx = args->client;
+        ctx->batch = malloc(BUFFER_SIZE);
+        if (!ctx->batch) {
+            return REPLY(PROTO_ST_FAILED, "BATCH FAILED\n");
+        }
+        ctx->batch_len = 0;
+        ctx->batch_count = 0;
+        ctx->batch_overflow = 0;
+        return REPLY(PROTO_ST_OK, NULL);
+    }
+
+    char text[BUFFER_SIZE];
+    char *ops[BATCH_MAX_OPS + 1];
+    int count = 0;
+    snprintf(text, sizeof(text), "%s", args->text);
+    for (char *save = NULL, *op = strtok_r(text, ";", &save); op; op = strtok_r(NULL, ";", &save)) {
+        while (*op == ' ' || *op == '\t') op++;
+        if (*op == '\0' || strcmp(op, "END") == 0) continue;  // 빈 항목과 끝의 END는 허용
+        if (count > BATCH_MAX_OPS) break;
+        ops[count++] = op;
+    }
+    return run_batch(libs, args->client, ops, count);
+}
+
+static size_t format_command_stats(char *buf, size_t size, int *count);
+
+enum { STATS_SUMMARY, STATS_COMMANDS, STATS_DEVICE };
+
+// STATS 인자: 반환값 = 조회할 지표 종류, 인자 전체가 COMMANDS/DEVICE가 아니면 -1
+static int parse_stats_view(const char *text) {
+    size_t len = strlen(text);
+    while (len > 0 && (text[len - 1] == ' ' || text[len - 1] == '\t' || text[len - 1] == '\r' || text[len - 1] == '\n')) len--;
+    if (len == 0) return STATS_SUMMARY;
+    if (len == 8 && strncmp(text, "COMMANDS", 8) == 0) return STATS_COMMANDS;
+    if (len == 6 && strncmp(text, "DEVICE", 6) == 0) return STATS_DEVICE;
+    return -1;
+}
+
+static CommandReply check_stats(const CommandArgs *args) {
+    if (parse_stats_view(args->text) < 0) {
+        return REPLY(PROTO_ST_BAD_ARG, "STATS FAILED (형식: STATS [COMMANDS|DEVICE])\n");
+    }
+    return CHECK_OK;
+}
+
+// 운영 지표 조회: "STATS" = 요약, "STATS COMMANDS" = 명령별, "STATS DEVICE" = 장치 호출별
+// (지연 시간은 2배 간격 구간의 상한으로 추정한 값, 같은 지표를 지표 포트에서 Prometheus 형식으로도 제공)
+static CommandReply cmd_stats(DeviceLibs *libs, const CommandArgs *args) {
+    static char reply_text[4096];
+    (void)libs;
+
+    CommandReply bad = check_stats(args);
+    if (bad.status != PROTO_ST_OK) return bad;
+
+    ServerMetrics *m = &server_metrics;
+    int view = parse_stats_view(args->text);
+    if (view == STATS_COMMANDS) {
+        int count = 0;
+        char list[sizeof(reply_text) - 64];
+        format_command_stats(list, sizeof(list), &count);
+        snprintf(reply_text, sizeof(reply_text), "STATS COMMANDS n=%d%s\n", count, list);
+        return REPLY_VALUE(PROTO_ST_OK, count, reply_text);
+    }
+    if (view == STATS_DEVICE) {
+        size_t len = 0;
+        int count = 0;
+        char list[sizeof(reply_text) - 64];
+        list[0] = '\0';
+        for (int i = 0; i < DEVICE_CALL_COUNT; ++i) {
+            const LatencyHistogram *h = &m->device_calls[i];
+            unsigned long calls = atomic_load(&h->count);
+            if (calls == 0) continue;
+            metrics_printf(list, sizeof(list), &len, " %s:%lu:%lu:%lu:%lu", device_call_names[i], calls,
+                           latency_percentile_us(h, 0.5), latency_percentile_us(h, 0.99), atomic_load(&h->max_us));
+            count++;
+        }
+        snprintf(reply_text, sizeof(reply_text), "STATS DEVICE n=%d%s\n", count, list);
+        return REPLY_VALUE(PROTO_ST_OK, count, reply_text);
+    }
+    SensorSample sample;
+    if (sensor_read(&sample) < 0) {
+        sample.seq = 0;
+        sample.changes = 0;
+    }
+    unsigned long p99 = latency_percentile_us(&m->commands, 0.99);
+    snprintf(reply_text, sizeof(reply_text),
+             "STATS uptime_s=%llu connections=%d accepted=%lu rejected=%lu commands=%lu unknown=%lu "
+             "cmd_p50_us=%lu cmd_p99_us=%lu cmd_max_us=%lu broadcasts=%lu broadcast_p99_us=%lu events_dropped=%lu "
+             "sensor_samples=%llu sensor_changes=%llu sensor_events=%lu lib_reloads=%lu reactors=%d queue_p99_us=%lu io=%s\n",
+             (unsigned long long)((metrics_now_ns() - m->start_ns) / 1000000000ULL),
+             atomic_load(&m->connections), atomic_load(&m->connections_accepted),
+             atomic_load(&m->connections_rejected), atomic_load(&m->commands.count),
+             atomic_load(&m->commands_unknown), latency_percentile_us(&m->commands, 0.5), p99,
+             atomic_load(&m->commands.max_us), atomic_load(&m->broadcasts.count),
+             latency_percentile_us(&m->broadcasts, 0.99), atomic_load(&m->events_dropped),
+             (unsigned long long)sample.seq, (unsigned long long)sample.changes,
+             atomic_load(&m->events[PROTO_EVT_CDS]), atomic_load(&m->lib_reloads), reactor_count,
+             latency_percentile_us(&m->command_queue, 0.99), io_backend_name());
+    return REPLY_VALUE(PROTO_ST_OK, (int)p99, reply_text);
+}
+
+// 장치 라이브러리 재적재 (같은 경로의 새 파일, 경로는 클라이언트가 정할 수 없음)
+static CommandReply cmd_reload(DeviceLibs *libs, const CommandArgs *args) {
+    static char reply_text[256];
+    (void)libs;
+    (void)args;
+    ProtoStatus status = device_libs_reload(reply_text, sizeof(reply_text));
+    return REPLY_VALUE(status, (int)libs_generation, reply_text);
+}
+
+// 장치 상태 조회: 하드웨어를 읽지 않고 캐시에서 바로 응답 (-1 = 아직 쓰지 않았거나 쓰기 실패)
+static CommandReply cmd_status(DeviceLibs *libs, const CommandArgs *args) {
+    static char reply_text[256];
+    (void)libs;
+    (void)args;
+
+    int led = device_state.led_level;
+    int segment = device_state.segment_digit;
+    int freq = atomic_load(&device_state.buzzer_freq);
+    int countdown = timer_pending(&segment_countdown_task);
+
+    snprintf(reply_text, sizeof(reply_text),
+             "STATUS led=%d segment=%d buzzer=%d sensor=%s countdown=%s quiz=%s writes=%lu skipped=%lu\n",
+             led, segment, freq, cds_monitor_running ? "on" : "off", countdown ? "on" : "off",
+             quiz_running ? "on" : "off", atomic_load(&device_state.writes), atomic_load(&device_state.skipped));
+
+    int value = (led < 0 ? PROTO_STATUS_UNKNOWN : led) |
+                (segment < 0 ? PROTO_STATUS_UNKNOWN : segment) << PROTO_STATUS_SEGMENT_SHIFT |
+                (cds_monitor_running ? PROTO_STATUS_SENSOR_ON : 0) |
+                (countdown ? PROTO_STATUS_COUNTDOWN : 0) |
+                (quiz_running ? PROTO_STATUS_QUIZ : 0) |
+                (freq > 0 ? freq & 0xFFFF : 0) << PROTO_STATUS_BUZZER_SHIFT;
+    return REPLY_VALUE(PROTO_ST_OK, value, reply_text);
+}
+
+// 명령 등록 테이블
+static const CommandEntry command_table[] = {
+    { "LED_ON",            PROTO_OP_LED_ON,            cmd_led_on,            NULL },
+    { "LED_OFF",           PROTO_OP_LED_OFF,           cmd_led_off,           NULL },
+    { "LED_BRIGHTNESS",    PROTO_OP_LED_BRIGHTNESS,    cmd_led_brightness,    check_led_brightness },
+    { "BUZZER_ON",         PROTO_OP_BUZZER_ON,         cmd_buzzer_on,         NULL },
+    { "BUZZER_OFF",        PROTO_OP_BUZZER_OFF,        cmd_buzzer_off,        NULL },
+    { "BUZZER_PATTERN",    PROTO_OP_BUZZER_PATTERN,    cmd_buzzer_pattern,    check_buzzer_pattern },
+    { "BUZZER_PLAY",       PROTO_OP_NONE,              cmd_buzzer_play,       check_buzzer_play },
+    { "BUZZER_STATS",      PROTO_OP_BUZZER_STATS,      cmd_buzzer_stats,      NULL },
+    { "SEGMENT_DISPLAY",   PROTO_OP_SEGMENT_DISPLAY,   cmd_segment_display,   check_segment_display },
+    { "SEGMENT_COUNTDOWN", PROTO_OP_SEGMENT_COUNTDOWN, cmd_segment_countdown, check_segment_countdown },
+    { "SEGMENT_STOP",      PROTO_OP_SEGMENT_STOP,      cmd_segment_stop,      NULL },
+    { "QUIZ_START",        PROTO_OP_QUIZ_START,        cmd_quiz_start,        NULL },
+    { "QUIZ_ANSWER",       PROTO_OP_QUIZ_ANSWER,       cmd_quiz_answer,       NULL },
+    { "SENSOR_ON",         PROTO_OP_SENSOR_ON,         cmd_sensor_on,         NULL },
+    { "SENSOR_OFF",        PROTO_OP_SENSOR_OFF,        cmd_sensor_off,        NULL },
+    { "SENSOR_READ",       PROTO_OP_SENSOR_READ,       cmd_sensor_read,       NULL },
+    { "SENSOR_FILTER",     PROTO_OP_SENSOR_FILTER,     cmd_sensor_filter,     check_sensor_filter },
+    { "SENSOR_HISTORY",    PROTO_OP_SENSOR_HISTORY,    cmd_sensor_history,    check_sensor_history },
+    { "STATUS",            PROTO_OP_STATUS,            cmd_status,            NULL },
+    { "SUBSCRIBE",         PROTO_OP_SUBSCRIBE,         cmd_subscribe,         check_subscribe },
+    { "UNSUBSCRIBE",       PROTO_OP_UNSUBSCRIBE,       cmd_unsubscribe,       check_unsubscribe },
+    { "BATCH",             PROTO_OP_NONE,              cmd_batch,             NULL },  // 바이너리는 drain_binary_frames에서 처리
+    { "STATS",             PROTO_OP_STATS,             cmd_stats,             check_stats },
+    { "RELOAD",            PROTO_OP_RELOAD,            cmd_reload,            NULL },
+};
+
+#define COMMAND_COUNT (sizeof(command_table) / sizeof(command_table[0]))
+#define COMMAND_HASH_SIZE 64  // 2의 거듭제곱, 등록 명령 수의 2배 이상 유지
+
+// 명령별 지표 (command_table과 같은 순서)
+typedef struct CommandMetrics {
+    LatencyHistogram latency;
+    atomic_ulong errors;  // OK가 아닌 응답 수
+} CommandMetrics;
+
+static CommandMetrics command_metrics[COMMAND_COUNT];
+
+// " 동사:처리 수:오류 수:p50_us:p99_us:max_us" 목록 (한 번 이상 처리된 명령만)
+static size_t format_command_stats(char *buf, size_t size, int *count) {
+    size_t len = 0;
+    buf[0] = '\0';
+    *count = 0;
+    for (size_t i = 0; i < COMMAND_COUNT; ++i) {
+        const LatencyHistogram *h = &command_metrics[i].latency;
+        unsigned long calls = atomic_load(&h->count);
+        if (calls == 0) continue;
+        metrics_printf(buf, size, &len, " %s:%lu:%lu:%lu:%lu:%lu", command_table[i].verb, calls,
+                       atomic_load(&command_metrics[i].errors), latency_percentile_us(h, 0.5),
+                       latency_percentile_us(h, 0.99), atomic_load(&h->max_us));
+        (*count)++;
+    }
+    return len;
+}
+
+// 동사 해시 → command_table 인덱스 + 1 (0 = 빈 슬롯), 시작 시 1회 구성
+static unsigned char command_hash_index[COMMAND_HASH_SIZE];
+
+// 바이너리 명령 코드 → command_table 인덱스 + 1 (0 = 미등록)
+static unsigned char command_opcode_index[256];
+
+// FNV-1a 해시 (동사 길이만큼)
+static unsigned int hash_verb(const char *verb, size_t len) {
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (unsigned char)verb[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// 명령 테이블로부터 해시 인덱스 구성 (main에서 이벤트 루프 시작 전 1회 호출)
+static void init_command_table(void) {
+    _Static_assert(COMMAND_COUNT * 2 <= COMMAND_HASH_SIZE, "COMMAND_HASH_SIZE가 너무 작음");
+
+    memset(command_hash_index, 0, sizeof(command_hash_index));
+    memset(command_opcode_index, 0, sizeof(command_opcode_index));
+    for (size_t i = 0; i < COMMAND_COUNT; ++i) {
+        const char *verb = command_table[i].verb;
+        unsigned int slot = hash_verb(verb, strlen(verb)) & (COMMAND_HASH_SIZE - 1);
+        while (command_hash_index[slot] != 0) {
+            slot = (slot + 1) & (COMMAND_HASH_SIZE - 1);  // 선형 탐사
+        }
+        command_hash_index[slot] = (unsigned char)(i + 1);
+        if (command_table[i].opcode != PROTO_OP_NONE) {
+            command_opcode_index[command_table[i].opcode] = (unsigned char)(i + 1);
+        }
+    }
+}
+
+// 동사로 명령 항목 검색: 정확히 일치하는 동사만 허용 (LED_ONX ≠ LED_ON)
+static const CommandEntry *find_command(const char *verb, size_t len) {
+    unsigned int slot = hash_verb(verb, len) & (COMMAND_HASH_SIZE - 1);
+    while (command_hash_index[slot] != 0) {
+        const CommandEntry *entry = &command_table[command_hash_index[slot] - 1];
+        if (strncmp(entry->verb, verb, len) == 0 && entry->verb[len] == '\0') {
+            return entry;
+        }
+        slot = (slot + 1) & (COMMAND_HASH_SIZE - 1);
+    }
+    return NULL;
+}
+
+// 핸들러 실행: 그 안에서 일어난 장치 쓰기는 이 명령을 원인으로 저널에 기록
+// 처리 시간과 결과는 명령별/전체 지표에 기록
+static CommandReply run_command(const CommandEntry *entry, DeviceLibs *libs, const CommandArgs *args) {
+    CommandMetrics *metrics = &command_metrics[entry - command_table];
+    uint64_t start_ns = metrics_now_ns();
+
+    journal_origin = (JournalOrigin){ JOURNAL_SRC_COMMAND, (uint8_t)entry->opcode, args->value };
+    CommandReply reply = entry->handler(libs, args);
+    journal_origin = (JournalOrigin){ JOURNAL_SRC_EVENT, 0, 0 };
+
+    latency_record_since(&metrics->latency, start_ns);
+    latency_record_since(&server_metrics.commands, start_ns);
+    if (reply.status != PROTO_ST_OK) {
+        atomic_fetch_add_explicit(&metrics->errors, 1, memory_order_relaxed);
+    }
+    return reply;
+}
+
+// 지표 포트 응답 본문 (내보내기 스레드에서 호출: 원자 값과 상수 표만 읽음)
+static size_t render_metrics(char *buf, size_t size) {
+    ServerMetrics *m = &server_metrics;
+    size_t len = 0;
+    char labels[96];
+
+    metrics_printf(buf, size, &len, "# TYPE device_server_uptime_seconds gauge\ndevice_server_uptime_seconds %.3f\n",
+                   (double)(metrics_now_ns() - m->start_ns) / 1e9);
+    metrics_printf(buf, size, &len, "# TYPE device_server_connections gauge\ndevice_server_connections %d\n",
+                   atomic_load(&m->connections));
+    metrics_printf(buf, size, &len, "# TYPE device_server_connections_accepted_total counter\n"
+                   "device_server_connections_accepted_total %lu\n", atomic_load(&m->connections_accepted));
+    metrics_printf(buf, size, &len, "# TYPE device_server_connections_rejected_total counter\n"
+                   "device_server_connections_rejected_total %lu\n", atomic_load(&m->connections_rejected));
+    metrics_printf(buf, size, &len, "# TYPE device_server_reactor_accepted_total counter\n");
+    for (int i = 0; i < reactor_count; ++i) {
+        metrics_printf(buf, size, &len, "device_server_reactor_accepted_total{reactor=\"%d\"} %lu\n", i,
+                       atomic_load_explicit(&reactors[i].accepted, memory_order_relaxed));
+    }
+    metrics_printf(buf, size, &len, "# TYPE device_server_reactor_waits_total counter\n");
+    for (int i = 0; i < reactor_count; ++i) {
+        metrics_printf(buf, size, &len, "device_server_reactor_waits_total{reactor=\"%d\",io=\"%s\"} %lu\n", i,
+                       io_backend_name(), atomic_load_explicit(&reactors[i].waits, memory_order_relaxed));
+    }
+    metrics_printf(buf, size, &len, "# TYPE device_server_lib_reloads_total counter\n"
+                   "device_server_lib_reloads_total{result=\"ok\"} %lu\n"
+                   "device_server_lib_reloads_total{result=\"failed\"} %lu\n",
+                   atomic_load(&m->lib_reloads), atomic_load(&m->lib_reload_failures));
+
+    metrics_printf(buf, size, &len, "# TYPE device_server_commands_unknown_total counter\n"
+                   "device_server_commands_unknown_total %lu\n", atomic_load(&m->commands_unknown));
+    metrics_printf(buf, size, &len, "# TYPE device_server_command_errors_total counter\n");
+    for (size_t i = 0; i < COMMAND_COUNT; ++i) {
+        metrics_printf(buf, size, &len, "device_server_command_errors_total{cmd=\"%s\"} %lu\n",
+                       command_table[i].verb, atomic_load(&command_metrics[i].errors));
+    }
+    metrics_printf(buf, size, &len, "# TYPE device_server_command_duration_seconds histogram\n");
+    for (size_t i = 0; i < COMMAND_COUNT; ++i) {
+        snprintf(labels, sizeof(labels), "cmd=\"%s\"", command_table[i].verb);
+        metrics_write_histogram(buf, size, &len, "device_server_command_duration_seconds", labels,
+                                &command_metrics[i].latency);
+    }
+
+    metrics_printf(buf, size, &len, "# TYPE device_server_device_call_duration_seconds histogram\n");
+    for (int i = 0; i < DEVICE_CALL_COUNT; ++i) {
+        snprintf(labels, sizeof(labels), "call=\"%s\"", device_call_names[i]);
+        metrics_write_histogram(buf, size, &len, "device_server_device_call_duration_seconds", labels,
+                                &m->device_calls[i]);
+    }
+
+    metrics_printf(buf, size, &len, "# TYPE device_server_broadcast_duration_seconds histogram\n");
+    metrics_write_histogram(buf, size, &len, "device_server_broadcast_duration_seconds", "", &m->broadcasts);
+    metrics_printf(buf, size, &len, "# TYPE device_server_command_queue_wait_seconds histogram\n");
+    metrics_write_histogram(buf, size, &len, "device_server_command_queue_wait_seconds", "", &m->command_queue);
+    metrics_printf(buf, size, &len, "# TYPE device_server_events_total counter\n");
+    for (int i = 1; i < EVENT_KIND_COUNT; ++i) {
+        metrics_printf(buf, size, &len, "device_server_events_total{event=\"%s\"} %lu\n", event_names[i],
+                       atomic_load(&m->events[i]));
+    }
+    metrics_printf(buf, size, &len, "# TYPE device_server_events_dropped_total counter\n"
+                   "device_server_events_dropped_total %lu\n", atomic_load(&m->events_dropped));
+
+    SensorSample sample;
+    if (sensor_read(&sample) < 0) {
+        sample.seq = 0;
+        sample.changes = 0;
+    }
+    metrics_printf(buf, size, &len, "# TYPE device_server_sensor_samples_total counter\n"
+                   "device_server_sensor_samples_total %llu\n", (unsigned long long)sample.seq);
+    metrics_printf(buf, size, &len, "# TYPE device_server_sensor_changes_total counter\n"
+                   "device_server_sensor_changes_total %llu\n", (unsigned long long)sample.changes);
+    return len;
+}
+
+// 클라이언트 명령을 장치 제어 함수로 매핑
+// 텍스트 명령 한 줄을 동사와 인자로 분리, 반환값: 명령 항목 (동사가 없거나 모르는 명령이면 NULL)
+static const CommandEntry *parse_command(const char *cmd, ClientContext *client, CommandArgs *args) {
+    // 동사 분리: 첫 공백/개행 전까지
+    while (*cmd == ' ' || *cmd == '\t') cmd++;
+    size_t verb_len = strcspn(cmd, " \t\r\n");
+    if (verb_len == 0) return NULL;
+
+    const CommandEntry *entry = find_command(cmd, verb_len);
+    if (!entry) return NULL;
+
+    // 인자 파싱: 공백을 건너뛴 나머지 문자열과 정수 값
+    args->text = cmd + verb_len;
+    while (*args->text == ' ' || *args->text == '\t') args->text++;
+
+    char *end = NULL;
+    errno = 0;
+    long value = strtol(args->text, &end, 10);
+    args->has_value = (end != args->text && errno == 0 && value >= INT_MIN && value <= INT_MAX);
+    args->value = args->has_value ? (int)value : 0;
+    args->client = client;
+    return entry;
+}
+
+static CommandReply handle_command(DeviceLibs *libs, ClientContext *client, const char *cmd) {
+    if (!cmd) return REPLY(PROTO_ST_INVALID, "INVALID COMMAND\n");
+
+    CommandArgs args;
+    const CommandEntry *entry = parse_command(cmd, client, &args);
+    if (!entry) {
+        while (*cmd == ' ' || *cmd == '\t') cmd++;
+        if (strcspn(cmd, " \t\r\n") == 0) return REPLY(PROTO_ST_INVALID, "INVALID COMMAND\n");
+        atomic_fetch_add_explicit(&server_metrics.commands_unknown, 1, memory_order_relaxed);
+        return REPLY(PROTO_ST_UNKNOWN, "UNKNOWN COMMAND\n");
+    }
+    return run_command(entry, libs, &args);
+}
+
+// BATCH 실행 전 장면: 실행 도중 명령이 실패하면 LED/7SEG를 되돌리고, 이 배치가 시작한 카운트다운/퀴즈는 취소
+// (둘 다 첫 틱이 다음 루프에서 돌므로 아직 아무것도 표시되지 않음)
+typedef struct BatchScene {
+    int led_level;
+    int segment_digit;
+    int countdown;  // 배치 전에 카운트다운 진행 중
+    int quiz;       // 배치 전에 퀴즈 진행 중
+} BatchScene;
+
+static void batch_scene_save(BatchScene *scene) {
+    scene->led_level = device_state.led_level;
+    scene->segment_digit = device_state.segment_digit;
+    scene->countdown = timer_pending(&segment_countdown_task);
+    scene->quiz = quiz_running;
+}
+
+static void batch_scene_restore(const BatchScene *scene) {
+    if (!scene->countdown && timer_pending(&segment_countdown_task)) {
+        timer_cancel(&segment_countdown_task);
+    }
+    if (!scene->quiz && quiz_running) {
+        timer_cancel(&quiz_task);
+        quiz_running = 0;
+    }
+    if (scene->led_level != DEVICE_STATE_UNKNOWN) device_led_set(scene->led_level, 0);
+    if (scene->segment_digit != DEVICE_STATE_UNKNOWN) device_segment_set(scene->segment_digit);
+}
+
+// BATCH 실행: 먼저 모든 동사와 인자를 확인하여 하나라도 틀리면 아무것도 실행하지 않고,
+// 순서대로 실행하다 상태 때문에 실패한 명령(BUSY 등)에서 멈추고 장면을 배치 전으로 되돌림
+// 장치 쓰기는 모두 I/O 루프 스레드가 소유하므로, 한 번의 호출 안에서 끝나는 배치 사이에는
+// 다른 연결의 명령이나 타이머 작업이 끼어들 수 없음
+static CommandReply run_batch(DeviceLibs *libs, ClientContext *client, char *const ops[], int count) {
+    static char reply_text[BUFFER_SIZE * 2];
+
+    if (count < 1 || count > BATCH_MAX_OPS) {
+        return REPLY(PROTO_ST_BAD_ARG, "BATCH FAILED (명령 1-16개)\n");
+    }
+    for (int i = 0; i < count; ++i) {
+        CommandArgs args;
+        const CommandEntry *entry = parse_command(ops[i], client, &args);
+        if (!entry || entry->handler == cmd_batch) {
+            const char *cmd = ops[i];
+            while (*cmd == ' ' || *cmd == '\t') cmd++;
+            snprintf(reply_text, sizeof(reply_text), "BATCH FAILED at=%d (알 수 없는 명령: %.*s)\n",
+                     i + 1, (int)strcspn(cmd, " \t\r\n"), cmd);
+            return REPLY(PROTO_ST_UNKNOWN, reply_text);
+        }
+        CommandReply bad = entry->check ? entry->check(&args) : CHECK_OK;
+        if (bad.status != PROTO_ST_OK) {
+            snprintf(reply_text, sizeof(reply_text), "BATCH FAILED at=%d n=%d | %.*s\n",
+                     i + 1, count, (int)strcspn(bad.text, "\n"), bad.text);
+            return REPLY_VALUE(bad.status, i, reply_text);
+        }
+    }
+
+    BatchScene scene;
+    batch_scene_save(&scene);
+
+    // 응답: "BATCH OK n=3 | 명령1 응답 | 명령2 응답 | ..." (각 응답의 개행은 제거)
+    char results[BUFFER_SIZE];
+    size_t len = 0;
+    results[0] = '\0';
+    int done = 0;
+    CommandReply reply = REPLY(PROTO_ST_OK, NULL);
+    while (done < count) {
+        reply = handle_command(libs, client, ops[done]);
+        int n = snprintf(results + len, sizeof(results) - len, " | %.*s",
+                         (int)strcspn(reply.text, "\n"), reply.text);
+        if (n > 0) len = (size_t)n < sizeof(results) - len ? len + (size_t)n : sizeof(results) - 1;
+        if (reply.status != PROTO_ST_OK) break;
+        done++;
+    }
+
+    if (done == count) {
+        snprintf(reply_text, sizeof(reply_text), "BATCH OK n=%d%s\n", count, results);
+        return REPLY_VALUE(PROTO_ST_OK, count, reply_text);
+    }
+    batch_scene_restore(&scene);
+    snprintf(reply_text, sizeof(reply_text), "BATCH FAILED at=%d n=%d%s\n", done + 1, count, results);
+    return REPLY_VALUE(reply.status, done, reply_text);
+}
+
+// 바이너리 명령 프레임의 인자 (문자열 인자 없음)
+static void binary_command_args(CommandArgs *args, ClientContext *client, uint8_t flags, int32_t arg) {
+    args->text = "";
+    args->has_value = (flags & PROTO_FLAG_HAS_ARG) != 0;
+    args->value = args->has_value ? arg : 0;
+    args->client = client;
+}
+
+// 바이너리 명령 프레임을 장치 제어 함수로 매핑 (문자열 파싱 없음)
+static CommandReply handle_binary_command(DeviceLibs *libs, ClientContext *client, uint8_t opcode, uint8_t flags,
+                                          int32_t arg) {
+    if (command_opcode_index[opcode] == 0) {
+        atomic_fetch_add_explicit(&server_metrics.commands_unknown, 1, memory_order_relaxed);
+        return REPLY(PROTO_ST_UNKNOWN, "UNKNOWN COMMAND\n");
+    }
+    const CommandEntry *entry = &command_table[command_opcode_index[opcode] - 1];
+
+    CommandArgs args;
+    binary_command_args(&args, client, flags, arg);
+    return run_command(entry, libs, &args);
+}
+
+// 소켓을 논블로킹 모드로 전환 (epoll 이벤트 루프에서 사용)
+static int set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return -1;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// epoll 등록 데이터 구분용 표식 (클라이언트는 ClientContext 포인터)
+static char listen_tag;  // 리스닝 소켓
+static char wake_tag;    // 리액터의 wake_fd (0번은 loop_wake_fd)
+static char timer_tag;   // 타이머 스케줄러 timerfd
+static char cds_edge_tag; // CDS 센서 엣지 알림 fd
+static char handoff_tag;  // 서버 교체 요청 소켓
+static char command_tag;  // 명령 큐 eventfd (장치 소유 스레드)
+
+static void handoff_serve(void);
+static void handoff_resume(void);
+
+// 클라이언트 참조 해제: 마지막 참조(레지스트리, 브로드캐스트 스냅샷, 실행 대기 명령)가 놓일 때 메모리 해제
+static void client_release(ClientContext *ctx)
+{
+    if (atomic_fetch_sub(&ctx->refs, 1) != 1) {
+        return;
+    }
+    // 레지스트리에서 제거되었고 스냅샷도 없으므로 다른 스레드가 송신 큐에 접근하지 않음
+    while (ctx->out.count > 0) {
+        out_message_release(*out_slot(&ctx->out, 0));
+        ctx->out.head = (ctx->out.head + 1) & (OUT_QUEUE_LEN - 1);
+        ctx->out.count--;
+    }
+    pthread_mutex_destroy(&ctx->out_lock);
+    free(ctx->batch);
+    free(ctx);
+}
+
+// 리액터의 연결 목록에 추가/제거 (그 리액터 스레드 전용, 제거 시 마지막 항목을 빈 자리로 옮김)
+static void reactor_add_client(Reactor *r, ClientContext *ctx)
+{
+    ctx->reactor = r;
+    ctx->reactor_pos = r->client_count;
+    r->clients[r->client_count++] = ctx;
+}
+
+static void reactor_remove_client(ClientContext *ctx)
+{
+    Reactor *r = ctx->reactor;
+    ClientContext *last = r->clients[--r->client_count];
+    r->clients[ctx->reactor_pos] = last;
+    last->reactor_pos = ctx->reactor_pos;
+    ctx->reactor_pos = -1;  // 닫힘 표시 (io_uring 완료가 늦게 도착해도 무시)
+}
+
+// 클라이언트 연결 종료: epoll 등록 해제, 레지스트리 제거, 소켓 닫기
+static void close_client(ClientContext *ctx)
+{
+    char log_msg[512];
+    char ip[INET_ADDRSTRLEN];
+
+    if (ctx->reactor->ring) {
+        // 링에 남은 수신/송신 요청이 바로 끝나도록 (각 요청이 가진 참조는 완료 처리에서 해제)
+        shutdown(ctx->socket_fd, SHUT_RDWR);
+    } else {
+        epoll_ctl(ctx->reactor->epoll_fd, EPOLL_CTL_DEL, ctx->socket_fd, NULL);
+    }
+    reactor_remove_client(ctx);
+    client_registry_remove(ctx);
+    close(ctx->socket_fd);
+
+    snprintf(log_msg, sizeof(log_msg), "클라이언트 연결 종료: %s:%d",
+             inet_ntop(AF_INET, &ctx->addr.sin_addr, ip, sizeof(ip)), ntohs(ctx->addr.sin_port));
+    log_event(log_msg);
+    if (ctx->out.dropped > 0) {
+        snprintf(log_msg, sizeof(log_msg), "느린 클라이언트 정책으로 버려진 이벤트: %lu개", ctx->out.dropped);
+        log_event_level(LOG_LEVEL_WARN, log_msg);
+    }
+
+    // 브로드캐스트 스레드가 스냅샷 참조를 들고 있거나 실행 대기 명령/링 요청이 남아 있으면 그쪽에서 마지막으로 해제
+    client_release(ctx);
+}
+
+// 최대 연결 수 초과: 안내 메시지만 보내고 즉시 종료 (논블로킹, 실패해도 무시)
+static void reject_client(int client_socket, const struct sockaddr_in *client_addr)
+{
+    static const char full_msg[] = "SERVER FULL\n";
+    char log_msg[512];
+    char ip[INET_ADDRSTRLEN];
+
+    if (send(client_socket, full_msg, sizeof(full_msg) - 1, MSG_NOSIGNAL | MSG_DONTWAIT) < 0) {
+        // 거부 안내는 최선 노력
+    }
+    close(client_socket);
+    atomic_fetch_add(&server_metrics.connections_rejected, 1);
+
+    snprintf(log_msg, sizeof(log_msg), "최대 연결 수(%d) 초과로 연결 거부: %s:%d",
+             client_registry.capacity, inet_ntop(AF_INET, &client_addr->sin_addr, ip, sizeof(ip)),
+             ntohs(client_addr->sin_port));
+    log_event_level(LOG_LEVEL_WARN, log_msg);
+}
+
+// 송신 큐 상태에 맞춰 EPOLLOUT 관심 등록/해제 (남은 데이터가 있을 때만 쓰기 이벤트 대기)
+static void update_write_interest(ClientContext *ctx)
+{
+    pthread_mutex_lock(&ctx->out_lock);
+    int pending = ctx->out.count > 0;
+    pthread_mutex_unlock(&ctx->out_lock);
+
+    if (pending == ctx->want_write) return;
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLRDHUP | (pending ? EPOLLOUT : 0);
+    ev.data.ptr = ctx;
+    if (epoll_ctl(ctx->reactor->epoll_fd, EPOLL_CTL_MOD, ctx->socket_fd, &ev) == 0) {
+        ctx->want_write = pending;
+    }
+}
+
+static int ring_send(ClientContext *ctx);
+
+// 송신 큐를 비우고 쓰기 관심 갱신, 연결 오류/정책 종료 시 -1
+// (io_uring 백엔드는 송신 요청을 SQ에 넣기만 하고 다음 대기 호출에서 함께 제출)
+static int service_output(ClientContext *ctx)
+{
+    if (atomic_load(&ctx->doomed)) {
+        return -1;
+    }
+    if (ctx->reactor->ring) {
+        return ring_send(ctx);
+    }
+    if (flush_client(ctx) < 0) {
+        return -1;
+    }
+    update_write_interest(ctx);
+    return 0;
+}
+
+// 수락한 소켓을 레지스트리와 리액터 연결 목록에 등록 (감시 등록은 호출부), 최대 연결 수 초과 시 NULL
+static ClientContext *register_client(Reactor *r, int client_socket, const struct sockaddr_in *client_addr)
+{
+    ClientContext *ctx = calloc(1, sizeof(ClientContext));
+    if (!ctx) {
+        perror("클라이언트 컨텍스트 할당 실패");
+        close(client_socket);
+        return NULL;
+    }
+    atomic_init(&ctx->refs, 1);  // 레지스트리 참조
+    ctx->socket_fd = client_socket;
+    ctx->addr = *client_addr;
+    // 응답은 입력 묶음마다 송신 큐에서 모아 한 번에 보내므로 Nagle 지연(상대 지연 ACK 대기)은 끄기
+    int nodelay = 1;
+    setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    pthread_mutex_init(&ctx->out_lock, NULL);
+    atomic_init(&ctx->doomed, 0);
+    atomic_init(&ctx->jobs, 0);
+    atomic_init(&ctx->topics, PROTO_TOPIC_ALL);  // 기존 클라이언트 호환: 처음에는 모든 주제 수신
+
+    // 레지스트리 등록 (여러 리액터가 동시에 수락하므로 빈 슬롯 확인도 등록과 함께 잠금 안에서)
+    if (client_registry_add(ctx) < 0) {
+        reject_client(client_socket, client_addr);
+        pthread_mutex_destroy(&ctx->out_lock);
+        free(ctx);
+        return NULL;
+    }
+    reactor_add_client(r, ctx);
+    atomic_fetch_add_explicit(&r->accepted, 1, memory_order_relaxed);
+
+    char log_msg[512];
+    char ip[INET_ADDRSTRLEN];
+    snprintf(log_msg, sizeof(log_msg), "클라이언트 연결됨: %s:%d",
+             inet_ntop(AF_INET, &client_addr->sin_addr, ip, sizeof(ip)), ntohs(client_addr->sin_port));
+    log_event(log_msg);
+    return ctx;
+}
+
+// 대기 중인 연결을 모두 수락하여 이 리액터의 epoll에 등록 (리스닝 소켓은 논블로킹)
+static void accept_clients(Reactor *r)
+{
+    while (1) {
+        struct sockaddr_in client_addr;
+        socklen_t client_addr_len = sizeof(client_addr);
+        int client_socket = accept4(r->listen_fd, (struct sockaddr *)&client_addr,
+                                    &client_addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_socket < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("연결 수락 실패");
+            }
+            return;
+        }
+
+        ClientContext *ctx = register_client(r, client_socket, &client_addr);
+        if (!ctx) continue;
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = ctx;
+        if (epoll_ctl(r->epoll_fd, EPOLL_CTL_ADD, client_socket, &ev) < 0) {
+            perror("클라이언트 epoll 등록 실패");
+            close_client(ctx);
+        }
+    }
+}
+
+// 응답을 해당 클라이언트 송신 큐에 추가 (실제 전송은 입력 처리 후 한 번에)
+// switch_binary가 1이면 응답을 넣는 것과 같은 잠금 안에서 바이너리 모드로 전환
+// (이후 브로드캐스트가 텍스트 응답보다 앞서 바이너리로 섞이지 않도록)
+// 반환값: 0 = 성공, -1 = 큐가 응답으로 가득 참(클라이언트가 읽지 않음)
+static int queue_response_data(ClientContext *ctx, const char *data, size_t len, int switch_binary)
+{
+    OutMessage *msg = out_message_new(MSG_RESPONSE, data, len);
+    if (!msg) return -1;
+
+    pthread_mutex_lock(&ctx->out_lock);
+    int rc = out_push_locked(ctx, msg);
+    if (rc == 0 && switch_binary) {
+        ctx->binary = 1;
+    }
+    pthread_mutex_unlock(&ctx->out_lock);
+
+    out_message_release(msg);
+    return rc;
+}
+
+static int queue_response(ClientContext *ctx, const char *response)
+{
+    return queue_response_data(ctx, response, strlen(response), 0);
+}
+
+// BATCH 수집 중 받은 줄: END면 모은 명령을 한 번에 실행하여 하나의 응답을 보내고, 아니면 버퍼에 추가
+static int collect_batch_line(ClientContext *ctx, const char *line)
+{
+    while (*line == ' ' || *line == '\t') line++;
+    if (strcmp(line, "END") != 0) {
+        size_t len = strlen(line) + 1;
+        if (ctx->batch_count >= BATCH_MAX_OPS || ctx->batch_len + len > BUFFER_SIZE) {
+            ctx->batch_overflow = 1;
+        } else {
+            memcpy(ctx->batch + ctx->batch_len, line, len);
+            ctx->batch_len += len;
+            ctx->batch_count++;
+        }
+        return 0;
+    }
+
+    char *ops[BATCH_MAX_OPS];
+    char *p = ctx->batch;
+    for (int i = 0; i < ctx->batch_count; ++i) {
+        ops[i] = p;
+        p += strlen(p) + 1;
+    }
+    CommandReply reply = ctx->batch_overflow
+        ? REPLY(PROTO_ST_BAD_ARG, "BATCH FAILED (명령 1-16개, 합계 1024바이트 이내)\n")
+        : run_batch(device_libs(), ctx, ops, ctx->batch_count);
+
+    free(ctx->batch);
+    ctx->batch = NULL;
+    return queue_response(ctx, reply.text);
+}
+
+// BINARY_HELLO 줄인지 확인 (이 줄 이후의 입력은 8바이트 프레임)
+static int is_binary_hello(const char *line)
+{
+    return strncmp(line, PROTO_BINARY_HELLO, sizeof(PROTO_BINARY_HELLO) - 2) == 0 &&
+           line[sizeof(PROTO_BINARY_HELLO) - 2] == '\0';
+}
+
+// 명령 프레임 하나를 처리하고 응답을 송신 큐에 추가
+// 반환값: 연결 유지 시 0, 송신 큐 포화 시 -1
+static int dispatch_frame(ClientContext *ctx, const char *line)
+{
+    char log_msg[512];
+
+    if (logger_enabled(LOG_LEVEL_INFO)) {
+        snprintf(log_msg, sizeof(log_msg), "수신된 메시지: %.*s", (int)(sizeof(log_msg) - 30), line);
+        log_event(log_msg);
+    }
+
+    // 바이너리 프로토콜 핸드셰이크: 응답 이후의 모든 데이터는 8바이트 프레임
+    // (입력 해석 전환은 리액터가 같은 줄을 보고 따로 함)
+    if (is_binary_hello(line)) {
+        return queue_response_data(ctx, PROTO_BINARY_ACK, sizeof(PROTO_BINARY_ACK) - 1, 1);
+    }
+
+    // BATCH 수집 중: END 전까지는 실행하지 않고 모아 둠
+    if (ctx->batch) {
+        return collect_batch_line(ctx, line);
+    }
+
+    CommandReply reply = handle_command(device_libs(), ctx, line);
+    if (!reply.text) {
+        return 0;  // 응답을 미루는 명령 (BATCH 시작)
+    }
+    return queue_response(ctx, reply.text);
+}
+
+// 바이너리 요청 프레임 하나를 처리하고 응답 프레임을 송신 큐에 추가
+static int dispatch_binary_frame(ClientContext *ctx, const uint8_t *frame)
+{
+    uint16_t request_id = proto_frame_id(frame);
+
+    if (logger_enabled(LOG_LEVEL_INFO)) {
+        char log_msg[128];
+        snprintf(log_msg, sizeof(log_msg), "수신된 바이너리 명령: op=0x%02x id=%u arg=%d",
+                 frame[0], request_id, (int)proto_frame_value(frame));
+        log_event(log_msg);
+    }
+
+    CommandReply reply = handle_binary_command(device_libs(), ctx, frame[0], frame[1], proto_frame_value(frame));
+
+    uint8_t out[PROTO_FRAME_SIZE];
+    proto_pack(out, frame[0], (uint8_t)reply.status, request_id, reply.value);
+    return queue_response_data(ctx, (const char *)out, sizeof(out), 0);
+}
+
+// 바이너리 BATCH: 헤더 프레임 뒤의 명령 프레임들을 한 번에 실행하고 응답 프레임 하나만 보냄
+// (모르는 명령 코드나 틀린 인자가 있으면 아무것도 실행하지 않음, 실행 중 실패하면 멈추고 장면을 되돌림)
+static int dispatch_binary_batch(ClientContext *ctx, const uint8_t *header, const uint8_t (*ops)[PROTO_FRAME_SIZE],
+                                 int count)
+{
+    ProtoStatus status = PROTO_ST_OK;
+    int done = 0;
+
+    if (logger_enabled(LOG_LEVEL_INFO)) {
+        char log_msg[128];
+        snprintf(log_msg, sizeof(log_msg), "수신된 바이너리 BATCH: id=%u 명령 %d개", proto_frame_id(header), count);
+        log_event(log_msg);
+    }
+
+    for (int i = 0; i < count && status == PROTO_ST_OK; ++i) {
+        if (command_opcode_index[ops[i][0]] == 0) {
+            status = PROTO_ST_UNKNOWN;
+            done = i;
+            break;
+        }
+        const CommandEntry *entry = &command_table[command_opcode_index[ops[i][0]] - 1];
+        CommandArgs args;
+        binary_command_args(&args, ctx, ops[i][1], proto_frame_value(ops[i]));
+        if (entry->check) {
+            status = entry->check(&args).status;
+            if (status != PROTO_ST_OK) done = i;
+        }
+    }
+
+    BatchScene scene;
+    batch_scene_save(&scene);
+    int checked = status == PROTO_ST_OK;
+    while (status == PROTO_ST_OK && done < count) {
+        CommandReply reply = handle_binary_command(device_libs(), ctx, ops[done][0], ops[done][1],
+                                                   proto_frame_value(ops[done]));
+        if (reply.status != PROTO_ST_OK) {
+            status = reply.status;
+            break;
+        }
+        done++;
+    }
+    if (checked && status != PROTO_ST_OK) {
+        batch_scene_restore(&scene);
+    }
+
+    uint8_t out[PROTO_FRAME_SIZE];
+    proto_pack(out, PROTO_OP_BATCH, (uint8_t)status, proto_frame_id(header), done);
+    return queue_response_data(ctx, (const char *)out, sizeof(out), 0);
+}
+
+// ===== 명령 프레임 실행 (장치 소유 스레드) =====
+// 리액터는 입력을 프레임으로 나누기만 하고, 명령 실행(장치 쓰기, 타이머, 저널)은 모두 I/O 루프(리액터 0)가 한다.
+// 리액터 0의 연결은 그 자리에서 바로 실행하고, 다른 리액터의 연결은 명령 큐로 넘겨 같은 순서로 실행한다.
+
+typedef enum FrameKind {
+    FRAME_TEXT,      // 텍스트 명령 한 줄 ('\0'까지 포함)
+    FRAME_BINARY,    // 바이너리 프레임 하나, 또는 BATCH 헤더 + 명령 프레임들
+    FRAME_TOO_LONG   // 길이 초과로 버린 텍스트 명령 (오류 응답만 보냄)
+} FrameKind;
+
+// 리액터 → 장치 소유 스레드 명령 프레임 (연결 참조 1개 보유)
+typedef struct CommandJob {
+    CmdQueueNode node;
+    ClientContext *ctx;
+    FrameKind kind;
+    uint64_t queued_ns;
+    size_t len;
+    char data[];
+} CommandJob;
+
+// 프레임 하나 실행 후 응답을 송신 큐에 추가, 송신 큐 포화 시 -1
+static int execute_frame(ClientContext *ctx, FrameKind kind, const char *data, size_t len)
+{
+    const uint8_t *frame = (const uint8_t *)data;
+
+    switch (kind) {
+    case FRAME_TEXT:
+        return dispatch_frame(ctx, data);
+    case FRAME_TOO_LONG:
+        return queue_response(ctx, "COMMAND TOO LONG\n");
+    case FRAME_BINARY:
+        break;
+    }
+
+    int count = (int)(len / PROTO_FRAME_SIZE) - 1;
+    if (count > 0) {
+        return dispatch_binary_batch(ctx, frame, (const uint8_t (*)[PROTO_FRAME_SIZE])(frame + PROTO_FRAME_SIZE),
+                                     count);
+    }
+    if (frame[0] == PROTO_OP_BATCH) {
+        uint8_t out[PROTO_FRAME_SIZE];  // 명령 수가 범위 밖: 명령 프레임은 리액터가 버리고 헤더만 거부
+        proto_pack(out, PROTO_OP_BATCH, PROTO_ST_BAD_ARG, proto_frame_id(frame), 0);
+        return queue_response_data(ctx, (const char *)out, sizeof(out), 0);
+    }
+    return dispatch_binary_frame(ctx, frame);
+}
+
+// 리액터가 꺼낸 프레임 처리: 리액터 0이면 바로 실행, 아니면 명령 큐에 넣고 응답은 나중에 송신 큐로 받음
+// 반환값: 연결 유지 시 0, 송신 큐 포화 또는 응답을 읽지 않아 실행 대기 명령이 쌓이면 -1
+static int submit_frame(ClientContext *ctx, FrameKind kind, const void *data, size_t len)
+{
+    if (ctx->reactor == &reactors[0]) {
+        return execute_frame(ctx, kind, data, len);
+    }
+
+    // 실행 대기 명령도 송신 큐와 같은 한도 (응답을 읽지 않는 연결은 단일 루프일 때와 같이 종료)
+    if (atomic_load(&ctx->jobs) >= OUT_QUEUE_LEN) {
+        return -1;
+    }
+    CommandJob *job = malloc(sizeof(CommandJob) + len);
+    if (!job) return -1;
+    job->ctx = ctx;
+    job->kind = kind;
+    job->queued_ns = metrics_now_ns();
+    job->len = len;
+    memcpy(job->data, data, len);
+
+    atomic_fetch_add(&ctx->refs, 1);
+    atomic_fetch_add(&ctx->jobs, 1);
+    cmdqueue_push(&command_queue, &job->node);
+    return 0;
+}
+
+// 명령 큐에서 최대 max개 실행 (I/O 루프), 응답이 생긴 리액터만 한 번씩 깨움
+static void run_queued_commands(int max)
+{
+    unsigned int kicked = 0;  // 리액터 번호 비트 (REACTOR_MAX <= 32)
+    int n = 0;
+
+    cmdqueue_begin_drain(&command_queue);
+    for (; n < max; ++n) {
+        CommandJob *job = (CommandJob *)cmdqueue_pop(&command_queue);
+        if (!job) break;
+
+        ClientContext *ctx = job->ctx;
+        latency_record_since(&server_metrics.command_queue, job->queued_ns);
+        if (!atomic_load(&ctx->doomed) && execute_frame(ctx, job->kind, job->data, job->len) < 0) {
+            atomic_store(&ctx->doomed, 1);  // 연결을 맡은 리액터가 종료
+        }
+        atomic_fetch_sub(&ctx->jobs, 1);
+        kicked |= 1u << ctx->reactor->id;
+        client_release(ctx);
+        free(job);
+    }
+    if (n == max) {
+        cmdqueue_rearm(&command_queue);  // 남은 명령은 다음 루프에서 (타이머/센서 이벤트를 먼저 처리)
+    }
+    for (int i = 0; kicked; ++i, kicked >>= 1) {
+        if (kicked & 1u) wake_reactor(&reactors[i]);
+    }
+}
+
+// ===== 리액터: 입력 프레임 분리와 소켓 I/O =====
+
+// 입력 링 버퍼의 offset 위치부터 프레임 하나 복사 (링 경계를 넘을 수 있음)
+static void peek_frame(const InputRing *in, size_t offset, uint8_t *frame)
+{
+    for (size_t i = 0; i < PROTO_FRAME_SIZE; ++i) {
+        frame[i] = (uint8_t)in->data[(in->head + offset + i) % BUFFER_SIZE];
+    }
+}
+
+// 바이너리 모드: 링 버퍼에서 완성된 8바이트 프레임을 모두 꺼내 처리
+// BATCH 헤더는 뒤따르는 명령 프레임이 모두 도착할 때까지 꺼내지 않음
+static int drain_binary_frames(ClientContext *ctx)
+{
+    InputRing *in = &ctx->in;
+    uint8_t frames[BATCH_MAX_OPS + 1][PROTO_FRAME_SIZE];  // 헤더 + 명령 프레임들
+
+    while (in->len >= PROTO_FRAME_SIZE) {
+        if (in->discarding > 0) {
+            // 명령 수 초과로 거부한 BATCH의 명령 프레임: 단독 명령으로 실행하지 않고 버림
+            size_t skip = in->len / PROTO_FRAME_SIZE;
+            if (skip > (size_t)in->discarding) skip = (size_t)in->discarding;
+            in->head = (in->head + skip * PROTO_FRAME_SIZE) % BUFFER_SIZE;
+            in->len -= skip * PROTO_FRAME_SIZE;
+            in->discarding -= (int)skip;
+            continue;
+        }
+
+        peek_frame(in, 0, frames[0]);
+        int count = 0;
+        if (frames[0][0] == PROTO_OP_BATCH) {
+            if (!(frames[0][1] & PROTO_FLAG_HAS_ARG) || proto_frame_value(frames[0]) < 0) {
+                // 뒤따르는 명령 프레임 수를 알 수 없어 이후 프레임 경계를 믿을 수 없음
+                log_event_level(LOG_LEVEL_WARN, "바이너리 BATCH 헤더에 명령 수가 없어 연결 종료");
+                return -1;
+            }
+            int32_t n = proto_frame_value(frames[0]);
+            if (n >= 1 && n <= BATCH_MAX_OPS) {
+                if (in->len < (size_t)(n + 1) * PROTO_FRAME_SIZE) break;
+                for (int i = 1; i <= n; ++i) {
+                    peek_frame(in, (size_t)i * PROTO_FRAME_SIZE, frames[i]);
+                }
+                count = n;
+            } else {
+                in->discarding = n;  // 헤더는 BAD_ARG로 거부하고 명령 프레임 n개는 도착하는 대로 버림
+            }
+        }
+        size_t consumed = (size_t)(count + 1) * PROTO_FRAME_SIZE;
+        in->head = (in->head + consumed) % BUFFER_SIZE;
+        in->len -= consumed;
+
+        if (submit_frame(ctx, FRAME_BINARY, frames, consumed) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 링 버퍼에서 완성된(개행으로 끝나는) 프레임을 모두 꺼내 순서대로 처리
+// 마지막의 미완성 프레임은 다음 recv까지 버퍼에 남겨 둔다
+static int drain_frames(ClientContext *ctx)
+{
+    InputRing *in = &ctx->in;
+    char line[BUFFER_SIZE];
+
+    if (in->binary) {
+        return drain_binary_frames(ctx);
+    }
+
+    while (in->scanned < in->len) {
+        size_t pos = (in->head + in->scanned) % BUFFER_SIZE;
+        if (in->data[pos] != '\n') {
+            in->scanned++;
+            continue;
+        }
+
+        // head ~ 개행 직전까지를 선형 버퍼로 복사 (링 경계를 넘을 수 있음)
+        size_t frame_len = in->scanned;
+        for (size_t i = 0; i < frame_len; ++i) {
+            line[i] = in->data[(in->head + i) % BUFFER_SIZE];
+        }
+        if (frame_len > 0 && line[frame_len - 1] == '\r') {
+            frame_len--;  // CRLF 허용
+        }
+        line[frame_len] = '\0';
+
+        in->head = (pos + 1) % BUFFER_SIZE;
+        in->len -= in->scanned + 1;
+        in->scanned = 0;
+
+        if (in->discarding) {
+            in->discarding = 0;  // 길이 초과 명령의 꼬리 부분
+            continue;
+        }
+        if (frame_len == 0) {
+            continue;  // 빈 줄 무시
+        }
+        if (submit_frame(ctx, FRAME_TEXT, line, frame_len + 1) < 0) {
+            return -1;
+        }
+        // 핸드셰이크 응답과 응답 형식 전환은 실행하는 쪽이 하고, 입력 해석은 여기서 바로 전환
+        if (is_binary_hello(line)) {
+            in->binary = 1;
+            return drain_binary_frames(ctx);  // 핸드셰이크 뒤에 이어 온 바이너리 프레임
+        }
+    }
+
+    // 버퍼가 가득 찼는데 개행이 없으면 명령이 너무 긴 것: 다음 개행까지 버리고 오류 응답
+    if (in->len == BUFFER_SIZE) {
+        in->head = 0;
+        in->len = 0;
+        in->scanned = 0;
+        if (in->discarding) {
+            return 0;  // 이미 오류 응답을 보낸 명령
+        }
+        in->discarding = 1;
+        log_event_level(LOG_LEVEL_WARN, "명령 길이 초과로 입력 버퍼 폐기");
+        return submit_frame(ctx, FRAME_TOO_LONG, "", 0);
+    }
+    return 0;
+}
+
+// 받은 바이트를 입력 링 버퍼로 옮기며 완성된 프레임을 처리 (io_uring 제공 버퍼에서 복사)
+// 반환값: 연결 유지 시 0, 연결 종료 시 -1
+static int client_input(ClientContext *ctx, const char *data, size_t len)
+{
+    InputRing *in = &ctx->in;
+
+    while (len > 0) {
+        // drain_frames 뒤에는 항상 빈 공간이 남음 (개행 없이 가득 차면 버퍼를 비움)
+        size_t tail = (in->head + in->len) % BUFFER_SIZE;
+        size_t room = BUFFER_SIZE - in->len;
+        if (room > BUFFER_SIZE - tail) {
+            room = BUFFER_SIZE - tail;
+        }
+        if (room > len) {
+            room = len;
+        }
+        memcpy(in->data + tail, data, room);
+        in->len += room;
+        data += room;
+        len -= room;
+        if (drain_frames(ctx) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 읽기 가능한 클라이언트 처리: 소켓이 빌 때까지 링 버퍼로 수신하고 완성된 프레임을 처리
+// 반환값: 연결 유지 시 0, 연결 종료 시 -1
+static int handle_client_input(ClientContext *ctx)
+{
+    InputRing *in = &ctx->in;
+
+    while (1) {
+        // 링 버퍼의 연속된 빈 공간에 바로 수신 (복사 없음)
+        size_t tail = (in->head + in->len) % BUFFER_SIZE;
+        size_t room = BUFFER_SIZE - in->len;
+        if (room > BUFFER_SIZE - tail) {
+            room = BUFFER_SIZE - tail;
+        }
+
+        int bytes_received = recv(ctx->socket_fd, in->data + tail, room, 0);
+        if (bytes_received == 0) {
+            return -1;  // 클라이언트 종료
+        }
+        if (bytes_received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;  // 더 읽을 데이터 없음
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;  // 오류
+        }
+
+        in->len += bytes_received;
+        if (drain_frames(ctx) < 0) {
+            return -1;
+        }
+    }
+}
+
+// 다른 스레드가 넣은 응답/브로드캐스트 송신 및 정책상 종료된 클라이언트 정리
+// 연결 목록은 이 리액터 스레드만 바꾸므로 잠금 없이 순회 가능
+static void service_broadcasts(Reactor *r)
+{
+    uint64_t counter;
+    if (read(r->wake_fd, &counter, sizeof(counter)) < 0) {
+        // 논블로킹 eventfd: 이미 비워진 경우
+    }
+
+    // 뒤에서부터 순회: 제거 시 마지막 항목이 현재 위치로 옮겨지므로 이미 처리한 항목만 이동
+    for (int i = r->client_count - 1; i >= 0; --i) {
+        ClientContext *ctx = r->clients[i];
+        if (atomic_load(&ctx->doomed) || (!ctx->want_write && service_output(ctx) < 0)) {
+            close_client(ctx);
+        }
+    }
+}
+
+// 클라이언트 소켓 이벤트 하나 처리 (연결을 맡은 리액터)
+static void serve_client(ClientContext *ctx, uint32_t events)
+{
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        close_client(ctx);
+        return;
+    }
+    // EPOLLRDHUP이어도 남은 데이터를 먼저 읽은 뒤 recv()==0으로 종료 처리
+    if ((events & (EPOLLIN | EPOLLRDHUP)) && handle_client_input(ctx) < 0) {
+        close_client(ctx);
+        return;
+    }
+    // 이번에 쌓인 응답(파이프라이닝된 명령 포함)을 한 번의 writev로 전송
+    if (service_output(ctx) < 0) {
+        close_client(ctx);
+    }
+}
+
+// ===== 이벤트 처리 (epoll / io_uring 공통) =====
+
+// epoll에 등록된 fd의 이벤트 하나 처리 (리스닝 소켓, wake_fd, 연결은 모든 리액터,
+// 명령 큐/타이머/센서 엣지/교체 요청은 리액터 0의 epoll에만 등록됨)
+static void dispatch_event(Reactor *r, void *tag, uint32_t events)
+{
+    if (tag == &listen_tag) {
+        accept_clients(r);
+        return;
+    }
+    if (tag == &wake_tag) {
+        service_broadcasts(r);
+        if (r->id == 0 && reload_requested) {
+            reload_requested = 0;
+            char detail[256];
+            device_libs_reload(detail, sizeof(detail));  // 결과는 로그로 남김
+        }
+        return;
+    }
+    if (tag == &command_tag) {
+        run_queued_commands(OWNER_DRAIN_MAX);
+        return;
+    }
+    if (tag == &timer_tag) {
+        timer_run_expired();
+        return;
+    }
+    if (tag == &cds_edge_tag) {
+        cds_monitor_on_edge();
+        return;
+    }
+    if (tag == &handoff_tag) {
+        handoff_serve();  // 교체에 성공하면 돌아오지 않음
+        return;
+    }
+    serve_client(tag, events);
+}
+
+// ===== io_uring 백엔드 =====
+// 리스닝 소켓과 연결 소켓은 링에서 직접 처리하고(다중 수락, 제공 버퍼 다중 수신, sendmsg),
+// 나머지 fd(wake_fd, 명령 큐, 타이머, 센서 엣지, 교체 요청)는 epoll에 그대로 두고 epoll fd 하나만 링에서 감시한다.
+// 루프 한 바퀴에 쌓인 송신/재등록 요청은 다음 대기 호출(io_uring_enter 한 번)에서 함께 제출된다.
+
+// 링 요청의 user_data = 대상 포인터(리액터 또는 연결, 8바이트 정렬) | 요청 종류
+enum {
+    RING_OP_ACCEPT = 1,  // 리액터: 다중 수락
+    RING_OP_POLL,        // 리액터: epoll fd 읽기 가능
+    RING_OP_RECV,        // 연결: 다중 수신 (연결 참조 1개 보유)
+    RING_OP_SEND,        // 연결: sendmsg (연결 참조 1개 보유)
+    RING_OP_CANCEL       // 모든 요청 취소 (대상 없음)
+};
+#define RING_OP_MASK 7u
+
+static uint64_t ring_tag(void *ptr, unsigned op)
+{
+    return (uint64_t)(uintptr_t)ptr | op;
+}
+
+static void ring_arm_accept(Reactor *r)
+{
+    if (uring_accept_multishot(r->ring, r->listen_fd, ring_tag(r, RING_OP_ACCEPT)) < 0) {
+        perror("io_uring 수락 등록 실패");
+        return;
+    }
+    r->ring_ops++;
+}
+
+static void ring_arm_poll(Reactor *r)
+{
+    if (uring_poll_multishot(r->ring, r->epoll_fd, ring_tag(r, RING_OP_POLL)) < 0) {
+        perror("io_uring epoll 감시 등록 실패");
+        return;
+    }
+    r->ring_ops++;
+}
+
+static int ring_arm_recv(ClientContext *ctx)
+{
+    Reactor *r = ctx->reactor;
+    if (uring_recv_multishot(r->ring, ctx->socket_fd, ring_tag(ctx, RING_OP_RECV)) < 0) {
+        return -1;
+    }
+    atomic_fetch_add(&ctx->refs, 1);
+    r->ring_ops++;
+    return 0;
+}
+
+// 송신 큐 앞쪽 메시지들을 sendmsg 요청 하나로 (연결당 한 번에 하나, 완료되면 남은 것을 이어서)
+static int ring_send(ClientContext *ctx)
+{
+    Reactor *r = ctx->reactor;
+    OutputQueue *q = &ctx->out;
+    if (r->ring_paused) {
+        return 0;  // 멈춤 해제 후 다시 보냄
+    }
+
+    pthread_mutex_lock(&ctx->out_lock);
+    if (q->sending > 0 || q->count == 0) {
+        pthread_mutex_unlock(&ctx->out_lock);
+        return 0;
+    }
+    int iovcnt = out_fill_iov_locked(q, ctx->send_iov);
+    q->sending = (size_t)iovcnt;
+    pthread_mutex_unlock(&ctx->out_lock);
+
+    memset(&ctx->send_msg, 0, sizeof(ctx->send_msg));
+    ctx->send_msg.msg_iov = ctx->send_iov;
+    ctx->send_msg.msg_iovlen = (size_t)iovcnt;
+    if (uring_sendmsg(r->ring, ctx->socket_fd, &ctx->send_msg, ring_tag(ctx, RING_OP_SEND)) < 0) {
+        pthread_mutex_lock(&ctx->out_lock);
+        q->sending = 0;
+        pthread_mutex_unlock(&ctx->out_lock);
+        return -1;
+    }
+    atomic_fetch_add(&ctx->refs, 1);
+    r->ring_ops++;
+    return 0;
+}
+
+// 다중 수락 완료: 연결 등록 후 다중 수신 등록 (주소는 연결마다 받지 않으므로 getpeername)
+static void ring_on_accept(Reactor *r, int res, uint32_t flags)
+{
+    if (res >= 0) {
+        struct sockaddr_in client_addr;
+        socklen_t client_addr_len = sizeof(client_addr);
+        memset(&client_addr, 0, sizeof(client_addr));
+        getpeername(res, (struct sockaddr *)&client_addr, &client_addr_len);
+        ClientContext *ctx = register_client(r, res, &client_addr);
+        if (ctx && !r->ring_paused && ring_arm_recv(ctx) < 0) {
+            close_client(ctx);
+        }
+    } else if (res != -ECANCELED) {
+        errno = -res;
+        perror("연결 수락 실패");
+    }
+    if (!(flags & IORING_CQE_F_MORE)) {
+        r->ring_ops--;
+        if (!r->ring_paused) ring_arm_accept(r);
+    }
+}
+
+// epoll fd 읽기 가능: 준비된 fd 이벤트를 모두 처리 (다중 감시는 새 이벤트가 올 때만 완료를 내므로 끝까지 비움)
+static void ring_on_poll(Reactor *r, uint32_t flags)
+{
+    if (!r->ring_paused) {
+        struct epoll_event events[MAX_EVENTS];
+        int n;
+        do {
+            n = epoll_wait(r->epoll_fd, events, MAX_EVENTS, 0);
+            for (int i = 0; i < n; ++i) {
+                dispatch_event(r, events[i].data.ptr, events[i].events);
+            }
+        } while (n == MAX_EVENTS);
+    }
+    if (!(flags & IORING_CQE_F_MORE)) {
+        r->ring_ops--;
+        if (!r->ring_paused) ring_arm_poll(r);
+    }
+}
+
+// 다중 수신 완료: 받은 바이트를 입력 버퍼로 옮겨 프레임 처리, 다중 수신이 끝났으면 다시 등록
+static void ring_on_recv(Reactor *r, ClientContext *ctx, int res, uint32_t flags)
+{
+    int open = ctx->reactor_pos >= 0;  // 이미 닫은 연결의 늦은 완료는 버퍼만 돌려줌
+
+    if (flags & IORING_CQE_F_BUFFER) {
+        unsigned bid = flags >> IORING_CQE_BUFFER_SHIFT;
+        if (open && res > 0 && client_input(ctx, uring_buffer(r->ring, bid), (size_t)res) < 0) {
+            close_client(ctx);
+            open = 0;
+        }
+        uring_recycle(r->ring, bid);
+    }
+    if (open) {
+        // 0 = 클라이언트 종료, ENOBUFS = 제공 버퍼가 잠시 모자람(다시 등록), ECANCELED = 멈춤
+        if (res == 0 || (res < 0 && res != -ENOBUFS && res != -ECANCELED) ||
+            (res > 0 && service_output(ctx) < 0)) {
+            close_client(ctx);
+            open = 0;
+        }
+    }
+    if (!(flags & IORING_CQE_F_MORE)) {
+        r->ring_ops--;
+        if (open && !r->ring_paused && ring_arm_recv(ctx) < 0) {
+            close_client(ctx);
+        }
+        client_release(ctx);
+    }
+}
+
+// 송신 완료: 보낸 만큼 송신 큐에서 해제하고 남은 것이 있으면 이어서 송신
+static void ring_on_send(Reactor *r, ClientContext *ctx, int res)
+{
+    pthread_mutex_lock(&ctx->out_lock);
+    ctx->out.sending = 0;
+    if (res > 0) {
+        out_consume_locked(&ctx->out, (size_t)res);
+    }
+    pthread_mutex_unlock(&ctx->out_lock);
+    r->ring_ops--;
+
+    if (ctx->reactor_pos >= 0 && res != -ECANCELED) {
+        if ((res < 0 && res != -EAGAIN && res != -EINTR) || service_output(ctx) < 0) {
+            close_client(ctx);
+        }
+    }
+    client_release(ctx);
+}
+
+static void ring_complete(Reactor *r, uint64_t user_data, int res, uint32_t flags)
+{
+    void *ptr = (void *)(uintptr_t)(user_data & ~(uint64_t)RING_OP_MASK);
+
+    switch (user_data & RING_OP_MASK) {
+    case RING_OP_ACCEPT:
+        ring_on_accept(r, res, flags);
+        break;
+    case RING_OP_POLL:
+        ring_on_poll(r, flags);
+        break;
+    case RING_OP_RECV:
+        ring_on_recv(r, ptr, res, flags);
+        break;
+    case RING_OP_SEND:
+        ring_on_send(r, ptr, res);
+        break;
+    default:
+        break;  // 취소 요청 자체의 완료
+    }
+}
+
+// 쌓인 요청을 제출하고 완료를 기다려 모두 처리, 대기 실패 시 -1
+static int ring_poll(Reactor *r)
+{
+    atomic_fetch_add_explicit(&r->waits, 1, memory_order_relaxed);
+    if (uring_submit_and_wait(r->ring) < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    struct io_uring_cqe *cqe;
+    while ((cqe = uring_peek(r->ring)) != NULL) {
+        uint64_t user_data = cqe->user_data;
+        int res = cqe->res;
+        uint32_t flags = cqe->flags;
+        uring_advance(r->ring);  // 처리 중에 다시 들어와도(서버 교체 시 멈춤) 같은 완료를 두 번 보지 않도록 먼저 넘김
+        ring_complete(r, user_data, res, flags);
+    }
+    return 0;
+}
+
+// 링 요청 등록: 다중 수락, epoll fd 감시, 연결마다 다중 수신과 남은 송신 (링 시작 시와 멈춤 해제 후)
+static void ring_arm_all(Reactor *r)
+{
+    r->ring_paused = 0;
+    ring_arm_accept(r);
+    ring_arm_poll(r);
+    for (int i = r->client_count - 1; i >= 0; --i) {
+        ClientContext *ctx = r->clients[i];
+        if (ring_arm_recv(ctx) < 0 || service_output(ctx) < 0) {
+            close_client(ctx);
+        }
+    }
+}
+
+// 링 요청을 모두 취소하고, 취소 전에 받은 데이터와 보낸 바이트까지 처리를 마칠 때까지 대기
+// (이후 송신 큐와 입력 버퍼가 소켓과 일치하므로 flush_client나 서버 교체 직렬화를 그대로 쓸 수 있음)
+static void ring_quiesce(Reactor *r)
+{
+    r->ring_paused = 1;
+    if (uring_cancel_all(r->ring, ring_tag(NULL, RING_OP_CANCEL)) < 0) {
+        perror("io_uring 요청 취소 실패");
+        return;
+    }
+    while (r->ring_ops > 0) {
+        if (ring_poll(r) < 0) {
+            perror("io_uring 대기 실패");
+            return;
+        }
+    }
+}
+
+// 링 생성 (SINGLE_ISSUER이므로 그 리액터 스레드에서 호출) 후 요청 등록
+static void ring_start(Reactor *r)
+{
+    IoRing *ring = malloc(sizeof(IoRing));
+    if (!ring || uring_init(ring, URING_BUF_COUNT, BUFFER_SIZE) < 0) {
+        perror("io_uring 링 생성 실패");
+        exit(1);
+    }
+    r->ring = ring;
+    ring_arm_all(r);
+}
+
+// 이벤트를 한 번 기다려 처리 (epoll_wait 또는 io_uring 제출/완료 대기), 대기 실패 시 -1
+static int reactor_poll(Reactor *r)
+{
+    if (r->ring) {
+        return ring_poll(r);
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    atomic_fetch_add_explicit(&r->waits, 1, memory_order_relaxed);
+    int n = epoll_wait(r->epoll_fd, events, MAX_EVENTS, -1);
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    for (int i = 0; i < n; ++i) {
+        dispatch_event(r, events[i].data.ptr, events[i].events);
+    }
+    return 0;
+}
+
+// ===== 리액터 스레드 관리 =====
+// I/O 루프가 모든 연결을 한 번에 다뤄야 하는 작업(서버 교체, 종료)은 다른 리액터를 멈춘 뒤 수행
+
+static atomic_int reactor_pause_requested = 0;
+static pthread_mutex_t reactor_pause_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reactor_pause_cond = PTHREAD_COND_INITIALIZER;
+static int reactors_parked = 0;
+
+// 작업 리액터: 링 요청을 멈추고 멈춤 요청이 풀릴 때까지 대기
+static void reactor_park(Reactor *r)
+{
+    if (r->ring) ring_quiesce(r);
+
+    pthread_mutex_lock(&reactor_pause_lock);
+    reactors_parked++;
+    pthread_cond_broadcast(&reactor_pause_cond);
+    while (atomic_load(&reactor_pause_requested)) {
+        pthread_cond_wait(&reactor_pause_cond, &reactor_pause_lock);
+    }
+    reactors_parked--;
+    pthread_mutex_unlock(&reactor_pause_lock);
+
+    if (r->ring) ring_arm_all(r);
+}
+
+// I/O 루프: 모든 작업 리액터가 처리 중인 이벤트를 마치고 멈출 때까지 대기한 뒤 자기 링 요청도 멈춤
+// (이후 레지스트리 active 배열과 각 연결의 입력 버퍼/송신 큐를 잠금 없이 다룰 수 있음)
+static void reactors_pause(void)
+{
+    if (reactor_threads > 0) {
+        atomic_store(&reactor_pause_requested, 1);
+        for (int i = 1; i < reactor_count; ++i) {
+            wake_reactor(&reactors[i]);
+        }
+        pthread_mutex_lock(&reactor_pause_lock);
+        while (reactors_parked < reactor_threads) {
+            pthread_cond_wait(&reactor_pause_cond, &reactor_pause_lock);
+        }
+        pthread_mutex_unlock(&reactor_pause_lock);
+    }
+    if (reactors && reactors[0].ring) {
+        ring_quiesce(&reactors[0]);
+    }
+}
+
+static void reactors_resume(void)
+{
+    if (reactors && reactors[0].ring) {
+        ring_arm_all(&reactors[0]);
+    }
+    if (reactor_threads == 0) return;
+
+    pthread_mutex_lock(&reactor_pause_lock);
+    atomic_store(&reactor_pause_requested, 0);
+    pthread_cond_broadcast(&reactor_pause_cond);
+    pthread_mutex_unlock(&reactor_pause_lock);
+}
+
+// 리액터 표 할당 (연결 목록은 최대 연결 수만큼 미리 확보), 리스닝 소켓은 호출부가 채움
+static int reactors_init(int count)
+{
+    reactors = calloc(count, sizeof(Reactor));
+    if (!reactors) return -1;
+    for (int i = 0; i < count; ++i) {
+        Reactor *r = &reactors[i];
+        r->id = i;
+        r->epoll_fd = -1;
+        r->wake_fd = -1;
+        r->listen_fd = -1;
+        r->clients = malloc(sizeof(ClientContext *) * client_registry.capacity);
+        if (!r->clients) return -1;
+    }
+    reactor_count = count;
+    return 0;
+}
+
+// 리액터 epoll과 wake_fd를 만들고 리스닝 소켓 등록 (io_uring 백엔드는 리스닝 소켓을 링에서 직접 받음)
+static int reactor_setup(Reactor *r)
+{
+    r->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    r->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (r->epoll_fd < 0 || r->wake_fd < 0) {
+        return -1;
+    }
+
+    struct epoll_event ev;
+    if (io_backend == IO_BACKEND_EPOLL) {
+        ev.events = EPOLLIN;
+        ev.data.ptr = &listen_tag;
+        if (epoll_ctl(r->epoll_fd, EPOLL_CTL_ADD, r->listen_fd, &ev) < 0) {
+            return -1;
+        }
+    }
+    ev.events = EPOLLIN;
+    ev.data.ptr = &wake_tag;
+    return epoll_ctl(r->epoll_fd, EPOLL_CTL_ADD, r->wake_fd, &ev);
+}
+
+// 작업 리액터 루프: 수락, 수신, 프레임 분리, 송신만 하고 명령은 명령 큐로 넘김
+static void *reactor_thread_func(void *arg)
+{
+    Reactor *r = arg;
+
+    if (io_backend == IO_BACKEND_URING) {
+        ring_start(r);
+    }
+    for (;;) {
+        if (atomic_load(&reactor_pause_requested)) {
+            reactor_park(r);
+        }
+        if (reactor_poll(r) < 0) {
+            perror("리액터 이벤트 대기 실패");
+            break;
+        }
+    }
+    return NULL;
+}
+
+// 작업 리액터 스레드 시작 (시그널은 메인 스레드만 받도록 모든 시그널을 막은 채 생성)
+static int reactors_start(void)
+{
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    int rc = 0;
+    for (int i = 1; i < reactor_count && rc == 0; ++i) {
+        rc = pthread_create(&reactors[i].thread, NULL, reactor_thread_func, &reactors[i]);
+        if (rc == 0) reactor_threads++;
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return rc == 0 ? 0 : -1;
+}
+
+// I/O 루프 (리액터 0 = 장치 소유 스레드): 자기 리스닝 소켓과 연결에 더해
+// 명령 큐, 타이머, 센서 엣지, 서버 교체 요청을 처리
+static void run_event_loop(void)
+{
+    for (int i = 0; i < reactor_count; ++i) {
+        if (reactor_setup(&reactors[i]) < 0) {
+            perror("리액터 epoll/eventfd 생성 실패");
+            exit(1);
+        }
+    }
+    epoll_fd = reactors[0].epoll_fd;
+    loop_wake_fd = reactors[0].wake_fd;
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &timer_tag;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd(), &ev) < 0) {
+        perror("timerfd epoll 등록 실패");
+        exit(1);
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = &command_tag;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, command_queue.wake_fd, &ev) < 0) {
+        perror("명령 큐 epoll 등록 실패");
+        exit(1);
+    }
+
+    if (handoff_listen_fd >= 0) {
+        ev.events = EPOLLIN;
+        ev.data.ptr = &handoff_tag;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, handoff_listen_fd, &ev) < 0) {
+            log_event_level(LOG_LEVEL_WARN, "교체 요청 소켓 epoll 등록 실패 (서버 교체 불가)");
+        }
+    }
+
+    // --upgrade로 시작했으면 이어받은 연결을 리액터에 나눠 주고 예약 작업 재개 (작업 리액터 시작 전)
+    handoff_resume();
+
+    Reactor *self = &reactors[0];
+    if (io_backend == IO_BACKEND_URING) {
+        ring_start(self);
+    }
+    if (reactors_start() < 0) {
+        perror("리액터 스레드 생성 실패");
+        exit(1);
+    }
+
+    while (!shutdown_requested) {
+        if (reactor_poll(self) < 0) {
+            perror("이벤트 대기 실패");
+            break;
+        }
+    }
+
+    shutdown_server();
+}
+
+// 필터가 확정한 센서 값 반영: LED 제어 및 클라이언트에 알림
+static void cds_apply_value(int value)
+{
+    char broadcast_msg[BUFFER_SIZE];
+
+    if (value == 0) {
+        // 빛이 감지됨 (value == 0) → LED OFF
+        device_led_set(0, 0);
+        log_event("[CDS 모니터] 빛 감지됨 → LED OFF");
+        snprintf(broadcast_msg, sizeof(broadcast_msg), "CDS_SENSOR: LIGHT_DETECTED (LED OFF)\n");
+    } else {
+        // 빛이 없음 (value == 1) → LED ON
+        device_led_set(LED_LEVEL_MAX, 0);
+        log_event("[CDS 모니터] 빛 없음 → LED ON");
+        snprintf(broadcast_msg, sizeof(broadcast_msg), "CDS_SENSOR: NO_LIGHT (LED ON)\n");
+    }
+
+    // 모든 연결된 클라이언트에 브로드캐스트 (느린 클라이언트에게는 최신 값으로 병합)
+    broadcast_event(broadcast_msg, MSG_EVENT_SENSOR, PROTO_EVT_CDS, value);
+}
+
+// 센서 값 하나를 읽어 게시하고 필터에 입력, 확정된 변화가 있으면 반영
+// 반환값: 필터가 보류 중인 후보를 다시 판정할 때까지 남은 시간 (보류 없음 = -1)
+static long cds_sample(void)
+{
+    int value = 0;
+    long recheck_ms = -1;
+    DeviceLibs *libs = device_libs();
+    if (!libs->sensor_get_value) {
+        return -1;
+    }
+    uint64_t start_ns = metrics_now_ns();
+    int ret = libs->sensor_get_value(&value);
+    latency_record_since(&server_metrics.device_calls[DEVICE_CALL_SENSOR_GET_VALUE], start_ns);
+    if (ret != 0) {
+        return -1;
+    }
+    sensor_publish(value);  // SENSOR_READ 등 다른 읽기용 최신 원시 샘플
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int stable = sensor_filter_push(value, (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec,
+                                    &recheck_ms);
+    if (stable >= 0) {
+        cds_apply_value(stable);
+    }
+    return recheck_ms;
+}
+
+// 폴링 모드: CDS_CHECK_INTERVAL마다 읽기, 엣지 모드: 놓친 엣지 보정을 위한 주기적 재확인
+// 필터가 후보를 보류 중이면 판정 시점에 맞춰 한 번 더 읽음
+static void cds_monitor_tick(void *arg)
+{
+    (void)arg;
+    long period = cds_edge_fd >= 0 ? CDS_EDGE_RESYNC_MS : CDS_CHECK_INTERVAL;
+    long recheck_ms = cds_sample();
+    if (recheck_ms >= 0 && recheck_ms < period) {
+        timer_schedule(&cds_monitor_task, recheck_ms);
+    } else {
+        timer_rearm(&cds_monitor_task, period);
+    }
+}
+
+// 엣지 알림 도착: 알림을 비우고 즉시 읽은 뒤 재확인 주기를 다시 시작
+static void cds_monitor_on_edge(void)
+{
+    uint64_t counter;
+    if (read(cds_edge_fd, &counter, sizeof(counter)) < 0) {
+        // 이미 비워진 경우
+    }
+    long recheck_ms = cds_sample();
+    timer_schedule(&cds_monitor_task,
+                   recheck_ms >= 0 && recheck_ms < CDS_EDGE_RESYNC_MS ? recheck_ms : CDS_EDGE_RESYNC_MS);
+}
+
+// CDS 센서 모니터링 시작: 센서 값 변화에 따라 LED 자동 제어
+// 라이브러리가 엣지 알림(sensor_edge_fd)을 지원하면 그 fd를 epoll에 등록하고,
+// 지원하지 않으면 CDS_CHECK_INTERVAL 간격의 타이머 작업으로 폴링한다.
+// stable: 이어서 판정할 필터 확정 값 (서버 교체 시 이전 서버의 값, -1 = 첫 샘플을 바로 확정해 현재 상태를 알림)
+static int cds_monitor_start(int stable)
+{
+    DeviceLibs *libs = device_libs();
+    if (libs->sensor_init) {
+        uint64_t start_ns = metrics_now_ns();
+        int ret = libs->sensor_init();
+        latency_record_since(&server_metrics.device_calls[DEVICE_CALL_SENSOR_INIT], start_ns);
+        if (ret < 0) {
+            log_event_level(LOG_LEVEL_ERROR, "CDS 센서 초기화 실패");
+            return -1;
+        }
+    }
+
+    if (stable >= 0) {
+        sensor_filter_seed(stable);
+    } else {
+        sensor_filter_reset();
+    }
+    cds_edge_fd = libs->sensor_edge_fd ? libs->sensor_edge_fd() : -1;
+    if (cds_edge_fd >= 0) {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = &cds_edge_tag;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, cds_edge_fd, &ev) < 0) {
+            perror("CDS 엣지 fd epoll 등록 실패");
+            cds_edge_fd = -1;
+        }
+    }
+
+    // 첫 값은 다음 루프에서 바로 읽음
+    if (timer_schedule(&cds_monitor_task, 0) < 0) {
+        if (cds_edge_fd >= 0) epoll_ctl(epoll_fd, EPOLL_CTL_DEL, cds_edge_fd, NULL);
+        cds_edge_fd = -1;
+        return -1;
+    }
+    cds_monitor_running = 1;
+    log_event(cds_edge_fd >= 0 ? "CDS 센서 모니터링 시작 (엣지 알림 모드)"
+                               : "CDS 센서 모니터링 시작 (엣지 알림 미지원 → 폴링 모드)");
+    return 0;
+}
+
+static void cds_monitor_stop(void)
+{
+    if (!cds_monitor_running) return;
+    timer_cancel(&cds_monitor_task);
+    if (cds_edge_fd >= 0) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, cds_edge_fd, NULL);
+        cds_edge_fd = -1;
+    }
+    cds_monitor_running = 0;
+    sensor_history_pause();  // 꺼져 있던 시간은 분 단위 관측 시간에서 제외
+    log_event("CDS 센서 모니터링 종료");
+}
+
+// ===== 장치 라이브러리 재적재 (RELOAD 명령, SIGHUP) =====
+// 1) 같은 경로의 파일을 새 인스턴스로 열어 새 표를 만들고 장치 초기화
+// 2) 표 포인터를 원자적으로 교체한 뒤, 캐시해 둔 LED/7SEG 상태를 새 라이브러리로 다시 씀
+// 3) 이전 표는 읽는 쪽이 모두 정지 상태를 지난 뒤 해제:
+//    I/O 루프는 지금 처리 중인 명령이 끝난 뒤(타이머 작업), 액추에이터는 libs_reader_epoch로 판단
+// 클라이언트 연결, 예약된 타이머 작업, 재생 중인 부저 작업은 그대로 유지됨
+
+#define LIBS_RECLAIM_POLL_MS 10  // 액추에이터가 이전 표로 장치를 호출하는 중이면 다시 확인할 간격
+
+static DeviceLibs *retired_libs = NULL;   // 해제 대기 중인 이전 표 (NULL = 없음)
+static unsigned long retired_epoch = 0;   // 교체 직후 읽은 libs_reader_epoch
+static TimerTask libs_reclaim_task = TIMER_TASK_INIT(device_libs_reclaim, NULL);
+
+// 새 라이브러리 인스턴스 열기: 이미 로드한 경로를 다시 dlopen하면 기존 핸들이 돌아오므로
+// 파일 내용을 memfd로 복사해 별개의 객체로 연다 (라이브러리 전역 변수도 새로 생김)
+// memfd는 핸들이 살아 있는 동안 열어 두어야 다음 재적재의 /proc/self/fd 경로와 겹치지 않음
+static void *load_library_copy(const char *path, int *image_fd) {
+    int src = open(path, O_RDONLY | O_CLOEXEC);
+    if (src < 0) {
+        char log_msg[2200];
+        snprintf(log_msg, sizeof(log_msg), "라이브러리 파일 열기 실패 (%s): %s", path, strerror(errno));
+        log_event_level(LOG_LEVEL_ERROR, log_msg);
+        return NULL;
+    }
+
+    void *handle = NULL;
+    struct stat st;
+    int mem = memfd_create("libdevice_manage", MFD_CLOEXEC);
+    if (mem >= 0 && fstat(src, &st) == 0) {
+        off_t offset = 0;
+        while (offset < st.st_size && sendfile(mem, src, &offset, (size_t)(st.st_size - offset)) > 0) {
+        }
+        if (offset == st.st_size) {
+            char fd_path[64];
+            snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", mem);
+            // 누락된 심볼은 교체 전에 여기서 실패하도록 즉시 바인딩
+            handle = load_library(fd_path, RTLD_NOW);
+        }
+    }
+    close(src);
+    if (!handle) {
+        if (mem >= 0) close(mem);
+        return NULL;
+    }
+    *image_fd = mem;
+    return handle;
+}
+
+// 표가 가리키는 라이브러리 정리 후 표 해제
+// 정리 함수가 0을 돌려준 경우에만 언로드 (없거나 실패하면 라이브러리 코드가 아직 불릴 수 있으므로 매핑 유지)
+static int device_libs_discard(DeviceLibs *libs) {
+    int unloaded = 0;
+    if (libs->device_handle && libs->device_release_all && libs->device_release_all() == 0) {
+        dlclose(libs->device_handle);
+        if (libs->image_fd >= 0) close(libs->image_fd);
+        unloaded = 1;
     }
+    free(libs);
+    return unloaded;
+}
 
-    // 데몬화 실행
-    // nochdir = 0: 작업 디렉토리를 / (루트)로 변경
-    // noclose = 0: 표준 입출력(stdin, stdout, stderr)을 /dev/null로 리다이렉트
-    if (daemon(0, 0) == -1) {
-        perror("daemon failed");
-        return 1;
+// 모니터링 중 라이브러리 교체: 엣지 fd를 새 라이브러리 것으로 바꾸고 바로 한 번 읽음 (놓친 엣지 보정)
+static void cds_monitor_rebind(void) {
+    if (cds_edge_fd >= 0) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, cds_edge_fd, NULL);
+        cds_edge_fd = -1;
+    }
+    DeviceLibs *libs = device_libs();
+    if (libs->sensor_init && libs->sensor_init() < 0) {
+        log_event_level(LOG_LEVEL_WARN, "재적재 후 CDS 센서 초기화 실패 (폴링으로 재시도)");
+    }
+    cds_edge_fd = libs->sensor_edge_fd ? libs->sensor_edge_fd() : -1;
+    if (cds_edge_fd >= 0) {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = &cds_edge_tag;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, cds_edge_fd, &ev) < 0) {
+            cds_edge_fd = -1;
+        }
     }
+    timer_schedule(&cds_monitor_task, 0);
+}
 
-    // 이제부터는 데몬 상태입니다.
-    // 데몬 프로세스의 PID를 파일에 저장 (실행 파일과 같은 디렉토리)
+static ProtoStatus device_libs_reload(char *detail, size_t size) {
+    if (retired_libs) {
+        snprintf(detail, size, "RELOAD BUSY (이전 라이브러리 해제 대기 중)\n");
+        return PROTO_ST_BUSY;
+    }
+
+    uint64_t start_ns = metrics_now_ns();
+    const char *lib_path = get_device_lib_path();
+    DeviceLibs *next = calloc(1, sizeof(DeviceLibs));
+    if (next) {
+        next->image_fd = -1;
+        next->device_handle = lib_path ? load_library_copy(lib_path, &next->image_fd) : NULL;
+    }
+    if (!next || !next->device_handle || resolve_symbols(next) < 0 ||
+        (next->device_init_all && next->device_init_all() < 0)) {
+        if (next) device_libs_discard(next);
+        atomic_fetch_add(&server_metrics.lib_reload_failures, 1);
+        char log_msg[2200];
+        snprintf(log_msg, sizeof(log_msg), "장치 라이브러리 재적재 실패: %s (기존 라이브러리 유지)",
+                 lib_path ? lib_path : "(경로 없음)");
+        log_event_level(LOG_LEVEL_ERROR, log_msg);
+        snprintf(detail, size, "RELOAD FAILED (기존 라이브러리 유지)\n");
+        return PROTO_ST_FAILED;
+    }
+
+    // 표 교체: 이후 액추에이터가 구간에 들어가면 새 표를 봄 (교체와 구간 번호 읽기 모두 순차 일관)
+    int led = device_state.led_level;
+    int segment = device_state.segment_digit;
+    retired_libs = atomic_exchange(&active_libs, next);
+    retired_epoch = atomic_load(&libs_reader_epoch);
+    libs_generation++;
+
+    // 새 인스턴스는 장치에 무엇이 쓰였는지 모르므로 캐시를 비우고 마지막 상태를 다시 씀
+    device_state.led_level = DEVICE_STATE_UNKNOWN;
+    device_state.segment_digit = DEVICE_STATE_UNKNOWN;
+    if (led != DEVICE_STATE_UNKNOWN) device_led_set(led, 0);
+    if (segment != DEVICE_STATE_UNKNOWN) device_segment_set(segment);
+    if (cds_monitor_running) cds_monitor_rebind();
+
+    // 호출자(명령 핸들러, BATCH)가 아직 이전 표 포인터를 들고 있을 수 있으므로 해제는 타이머로 미룸
+    if (timer_schedule(&libs_reclaim_task, 0) < 0) {
+        log_event_level(LOG_LEVEL_WARN, "이전 장치 라이브러리 해제 예약 실패 (종료 시 해제)");
+    }
+
+    long elapsed_us = (long)((metrics_now_ns() - start_ns) / 1000);
+    atomic_fetch_add(&server_metrics.lib_reloads, 1);
+    char log_msg[2400];
+    snprintf(log_msg, sizeof(log_msg), "장치 라이브러리 재적재 #%u: %s (LED %d, 7SEG %d 다시 적용, %ld us)",
+             libs_generation, lib_path, led, segment, elapsed_us);
+    log_event(log_msg);
+    snprintf(detail, size, "RELOAD OK #%u (%ld us)\n", libs_generation, elapsed_us);
+    return PROTO_ST_OK;
+}
+
+// 이전 표 해제 (타이머 작업, 종료 시에도 호출)
+static void device_libs_reclaim(void *arg) {
+    (void)arg;
+    if (!retired_libs) return;
+    if ((retired_epoch & 1) && atomic_load(&libs_reader_epoch) == retired_epoch) {
+        // 액추에이터가 교체 전부터 이전 표로 부저를 호출하는 중
+        timer_schedule(&libs_reclaim_task, LIBS_RECLAIM_POLL_MS);
+        return;
+    }
+
+    // 교체 전후에 액추에이터가 이전 라이브러리로 쓴 주파수는 새 라이브러리에 없음: 다음 쓰기는 반드시 수행
+    atomic_store(&device_state.buzzer_freq, DEVICE_STATE_UNKNOWN);
+    DeviceLibs *old = retired_libs;
+    retired_libs = NULL;
+    if (device_libs_discard(old)) {
+        log_event("이전 장치 라이브러리 언로드 완료");
+    } else {
+        log_event_level(LOG_LEVEL_WARN, "이전 장치 라이브러리는 정리 함수가 없거나 언로드할 수 없어 매핑 유지");
+    }
+}
+
+// 7SEG 카운트다운 틱: 현재 숫자 표시, 0이면 알람 후 완료 알림, 아니면 1초 뒤 다음 숫자
+static void segment_countdown_tick(void *arg)
+{
+    (void)arg;
+    int n = segment_countdown_value;
+    device_segment_set(n);
+
+    if (n == 0) {
+        // 0.5초 알람은 액추에이터 스레드가 재생
+        actuator_play(BUZZER_PATTERN_ALARM, 0);
+        broadcast_to_clients("SEGMENT_COUNTDOWN: COMPLETE\n", PROTO_EVT_COUNTDOWN_COMPLETE);
+        log_event("7SEG 카운트다운 완료");
+        return;
+    }
+    segment_countdown_value = n - 1;
+    timer_rearm(&segment_countdown_task, 1000);
+}
+
+// 퀴즈 틱 (5초 제한): 7SEG 표시 + 부저, 0초가 되면 시간 초과 처리
+static void quiz_tick(void *arg)
+{
+    (void)arg;
+    int n = quiz_remaining;
+    device_segment_set(n);
+
+    // 부저 패턴: 5~3초는 warning, 2~1초는 emergency (각 0.2초, 액추에이터 스레드가 재생)
+    if (n > 2) {
+        actuator_play(BUZZER_PATTERN_WARNING, 0);
+    } else if (n > 0) {
+        actuator_play(BUZZER_PATTERN_EMERGENCY, 0);
+    } else {
+        // 0초에 fail 소리 (낮은 쿠쿵), 재생 요청 후 즉시 메시지 전송 (클라이언트에서 0.2초 대기)
+        actuator_play(BUZZER_PATTERN_FAIL, 0);
+        quiz_running = 0;
+        broadcast_to_clients("QUIZ RESULT: TIMEOVER\n", PROTO_EVT_QUIZ_TIMEOVER);
+        log_event("퀴즈 종료: 시간 초과");
+        return;
+    }
+    quiz_remaining = n - 1;
+    timer_rearm(&quiz_task, 1000);  // 직전 마감 기준 1초 (표시/요청 시간이 누적되지 않음)
+}
+
+// 저널을 열고 마지막으로 기록된 LED/7SEG 상태를 다시 씀 (알 수 없는 항목은 초기 상태 유지)
+static void restore_device_state(void)
+{
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    JournalState restored;
+    int ret = journal_open(get_journal_path(), &restored);
+    if (ret < 0) {
+        log_event_level(LOG_LEVEL_WARN, "장치 상태 저널을 열 수 없어 기록 없이 실행");
+        return;
+    }
+    if (ret == 0) {
+        log_event("장치 상태 저널 새로 시작");
+        return;
+    }
+
+    journal_origin.source = JOURNAL_SRC_RESTORE;
+    if (restored.led_level >= 0) device_led_set(restored.led_level, 0);
+    if (restored.segment_digit >= 0) device_segment_set(restored.segment_digit);
+    journal_origin.source = JOURNAL_SRC_EVENT;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long elapsed_us = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_nsec - start.tv_nsec) / 1000L;
+    char log_msg[256];
+    snprintf(log_msg, sizeof(log_msg), "장치 상태 복원: LED %d, 7SEG %d (레코드 #%llu, 체크포인트 이후 %d개, %ld us)",
+             restored.led_level, restored.segment_digit, (unsigned long long)restored.seq, restored.replayed,
+             elapsed_us);
+    log_event(log_msg);
+}
+
+// 데몬 프로세스의 PID를 파일에 저장 (실행 파일과 같은 디렉토리)
+static void write_pid_file(void) {
     const char *pid_path = get_pid_file_path();
     FILE *pid_fp = fopen(pid_path, "w");
     if (pid_fp) {
@@ -866,33 +3661,17 @@ int main(int argc, char *argv[]) {
     } else {
         char log_msg[512];
         snprintf(log_msg, sizeof(log_msg), "PID 파일 생성 실패: %s (권한 문제 가능성)", pid_path);
-        log_event(log_msg);
-    }
-    log_event("서버 데몬 프로세스 시작");
-
-    // 시그널 핸들러 등록
-    signal(SIGTERM, signal_handler);
-    signal(SIGINT, signal_handler);
-
-    // 장치 라이브러리 로딩 (이미 get_exe_directory()가 호출되어 경로가 저장됨)
-    if (load_symbols(&g_libs) < 0) {
-        log_event("라이브러리 로드 실패로 종료");
-        exit(1);
+        log_event_level(LOG_LEVEL_WARN, log_msg);
     }
+}
 
-    // CDS 센서 라이브러리 확인 (스레드는 SENSOR_ON 명령으로 시작)
-    if (g_libs.sensor_init && g_libs.sensor_get_value) {
-        log_event("CDS 센서 라이브러리 로드됨 (SENSOR_ON 명령으로 모니터링 시작 가능)");
-    } else {
-        log_event("경고: CDS 센서 라이브러리가 없어 자동 제어 기능을 사용할 수 없습니다.");
-    }
-    
-    int client_socket;
-    struct sockaddr_in server_addr, client_addr;
-    socklen_t client_addr_len = sizeof(client_addr);
+// 장치 제어 포트 리스닝 소켓 생성 (실패 시 종료)
+// 리액터마다 하나씩 같은 포트에 열고, 커널이 SO_REUSEPORT로 새 연결을 리액터들에 나눔
+static int open_server_socket(int backlog) {
+    struct sockaddr_in server_addr;
 
     // 소켓 생성
-    server_socket = socket(AF_INET, SOCK_STREAM, 0);
+    int server_socket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
     if (server_socket < 0) {
         perror("소켓 생성 실패");
         exit(1);
@@ -900,7 +3679,8 @@ int main(int argc, char *argv[]) {
 
     // 소켓 옵션 설정 (재사용 가능하도록)
     int opt = 1;
-    if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+    if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+        setsockopt(server_socket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
         perror("setsockopt 실패");
         exit(1);
     }
@@ -917,44 +3697,626 @@ int main(int argc, char *argv[]) {
         exit(1);
     }
 
+    // 논블로킹 리스닝 소켓 (epoll 루프에서 accept가 블로킹되지 않도록)
+    if (set_nonblocking(server_socket) < 0) {
+        perror("논블로킹 설정 실패");
+        exit(1);
+    }
+
     // 리스닝
-    if (listen(server_socket, 5) < 0) {
+    if (listen(server_socket, backlog) < 0) {
         perror("리스닝 실패");
         exit(1);
     }
+    return server_socket;
+}
+
+// ===== 서버 교체 (실행 파일 업그레이드) =====
+// 새 서버를 --upgrade로 실행하면 실행 중인 서버의 핸드오프 소켓에 연결해 다음을 넘겨받는다.
+// - 리스닝 소켓(장치 제어 포트, 지표 포트)과 모든 클라이언트 소켓 fd (SCM_RIGHTS)
+// - LED/7SEG 상태, 진행 중인 카운트다운/퀴즈(다음 틱까지 남은 시간), 센서 모니터링 여부와 필터 설정
+// - 연결별 구독 주제, 프로토콜 모드, 아직 처리하지 않은 입력, 모으던 BATCH, 아직 보내지 못한 응답
+// 이전 서버는 전달하는 동안 I/O 루프가 멈춰 있으므로 그 사이 도착한 요청은 소켓 버퍼에 남아 새 서버가 읽는다.
+// 새 서버가 READY를 보내면 이전 서버는 저널을 닫고 COMMIT을 보낸 뒤 종료하며, 그 전에 실패하면 계속 실행한다.
+// 포트가 닫히는 구간도, 끊기는 연결도 없으므로 클라이언트는 재연결하지 않는다.
+
+#define HANDOFF_MAGIC 0x46464F48U      // "HOFF"
+#define HANDOFF_VERSION 3              // 아래 레코드 형식이 바뀌면 올림 (버전이 다르면 교체 거부)
+#define HANDOFF_OUT_MAX (1024 * 1024)  // 연결 하나의 미전송 응답 최대 크기 (받는 쪽 검사용)
+
+typedef enum HandoffStep {
+    HANDOFF_HELLO  = 1,  // 새 서버 → 이전 서버: 교체 요청
+    HANDOFF_READY  = 2,  // 새 서버 → 이전 서버: 모두 받음 (value = 이어받은 연결 수)
+    HANDOFF_COMMIT = 3   // 이전 서버 → 새 서버: 저널을 닫았으니 이어서 실행
+} HandoffStep;
+
+typedef struct HandoffControl {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t step;
+    int32_t value;
+} HandoffControl;
+
+// 서버 상태: 리액터별 리스닝 소켓 fd들(있으면 뒤에 지표 포트 fd도)과 함께 전송
+typedef struct HandoffHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t listener_count;      // 붙인 fd 중 앞쪽의 리스닝 소켓 수
+    int32_t has_metrics;         // 마지막 fd가 지표 포트이면 1
+    int32_t led_level;
+    int32_t segment_digit;
+    int32_t countdown_value;     // 다음 틱에 표시할 숫자
+    int32_t countdown_delay_ms;  // 다음 틱까지 남은 시간 (-1 = 진행 중 아님)
+    int32_t quiz_remaining;
+    int32_t quiz_delay_ms;       // -1 = 진행 중 아님
+    int32_t sensor_monitor;      // CDS 모니터링 실행 중
+    int32_t sensor_stable;       // 필터 확정 값 (-1 = 아직 없음)
+    SensorFilterConfig filter;
+    int32_t client_count;        // 뒤따르는 HandoffClient 수
+} HandoffHeader;
+
+// 연결 하나: 소켓 fd와 함께 전송, 뒤이어 입력 + BATCH + 미전송 응답 바이트를 이어 붙여 전송
+typedef struct HandoffClient {
+    struct sockaddr_in addr;
+    uint32_t topics;
+    int32_t binary;
+    int32_t discarding;
+    int32_t batch_active;
+    int32_t batch_count;
+    int32_t batch_overflow;
+    uint32_t in_len;
+    uint32_t batch_len;
+    uint32_t out_len;
+} HandoffClient;
+
+static HandoffHeader handoff_resume_state;  // 이어받은 상태 (handoff_resume에서 타이머/모니터링 재개)
+static int handoff_adopted = 0;             // 업그레이드로 시작해 아직 재개하지 않았으면 1
+
+// 예약된 작업의 다음 실행까지 남은 시간 (예약되지 않았으면 -1)
+static int32_t timer_remaining_ms(const TimerTask *task) {
+    if (!timer_pending(task)) return -1;
+    uint64_t now = metrics_now_ns();
+    return task->deadline_ns > now ? (int32_t)((task->deadline_ns - now) / 1000000ULL) : 0;
+}
+
+// 연결 하나 전송 (이전 서버): 보낼 수 있는 응답은 먼저 보내고 나머지는 바이트로 넘김
+static int handoff_send_client(int fd, ClientContext *ctx) {
+    flush_client(ctx);
+
+    HandoffClient rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.addr = ctx->addr;
+    rec.topics = atomic_load(&ctx->topics);
+    rec.discarding = ctx->in.discarding;
+    rec.batch_active = ctx->batch != NULL;
+    rec.batch_count = ctx->batch_count;
+    rec.batch_overflow = ctx->batch_overflow;
+    rec.in_len = (uint32_t)ctx->in.len;
+    rec.batch_len = ctx->batch ? (uint32_t)ctx->batch_len : 0;
+
+    pthread_mutex_lock(&ctx->out_lock);
+    OutputQueue *q = &ctx->out;
+    size_t out_len = 0;
+    for (size_t i = 0; i < q->count; ++i) {
+        out_len += (*out_slot(q, i))->len - (i == 0 ? q->head_offset : 0);
+    }
+    size_t total = rec.in_len + rec.batch_len + out_len;
+    char *data = malloc(total > 0 ? total : 1);
+    if (!data) {
+        pthread_mutex_unlock(&ctx->out_lock);
+        return -1;
+    }
+    char *p = data + rec.in_len + rec.batch_len;
+    for (size_t i = 0; i < q->count; ++i) {
+        OutMessage *msg = *out_slot(q, i);
+        size_t skip = (i == 0) ? q->head_offset : 0;
+        memcpy(p, msg->data + skip, msg->len - skip);
+        p += msg->len - skip;
+    }
+    rec.binary = ctx->binary;
+    pthread_mutex_unlock(&ctx->out_lock);
+    rec.out_len = (uint32_t)out_len;
+
+    for (size_t i = 0; i < ctx->in.len; ++i) {
+        data[i] = ctx->in.data[(ctx->in.head + i) % BUFFER_SIZE];
+    }
+    if (rec.batch_len > 0) {
+        memcpy(data + rec.in_len, ctx->batch, rec.batch_len);
+    }
+
+    int rc = (handoff_send(fd, &rec, sizeof(rec), &ctx->socket_fd, 1) < 0 ||
+              handoff_send_data(fd, data, total) < 0) ? -1 : 0;
+    free(data);
+    return rc;
+}
+
+// 교체 요청 처리 (이전 서버, I/O 루프): 성공하면 종료하고 돌아오지 않음
+static void handoff_serve(void) {
+    pid_t peer = 0;
+    int fd = handoff_accept(handoff_listen_fd, &peer);
+    if (fd < 0) {
+        if (errno == EPERM) log_event_level(LOG_LEVEL_WARN, "다른 사용자의 서버 교체 요청 거부");
+        return;
+    }
 
     char log_msg[256];
-    snprintf(log_msg, sizeof(log_msg), "서버가 포트 %d에서 대기 중...", PORT);
+    HandoffControl hello;
+    if (handoff_recv(fd, &hello, sizeof(hello), NULL, NULL) != (ssize_t)sizeof(hello) ||
+        hello.magic != HANDOFF_MAGIC || hello.step != HANDOFF_HELLO || hello.version != HANDOFF_VERSION) {
+        snprintf(log_msg, sizeof(log_msg), "서버 교체 요청 거부 (PID %d): 형식 또는 버전 불일치", (int)peer);
+        log_event_level(LOG_LEVEL_WARN, log_msg);
+        close(fd);
+        return;
+    }
+
+    // 다른 리액터를 멈추고 실행 대기 명령을 모두 실행해 응답까지 송신 큐에 넣은 뒤 넘김
+    reactors_pause();
+    run_queued_commands(INT_MAX);
+
+    ClientRegistry *r = &client_registry;
+    HandoffHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = HANDOFF_MAGIC;
+    header.version = HANDOFF_VERSION;
+    header.led_level = device_state.led_level;
+    header.segment_digit = device_state.segment_digit;
+    header.countdown_value = segment_countdown_value;
+    header.countdown_delay_ms = timer_remaining_ms(&segment_countdown_task);
+    header.quiz_remaining = quiz_remaining;
+    header.quiz_delay_ms = quiz_running ? timer_remaining_ms(&quiz_task) : -1;
+    header.sensor_monitor = cds_monitor_running;
+    header.sensor_stable = sensor_filter_stable();
+    sensor_filter_get_config(&header.filter);
+    for (int i = 0; i < r->count; ++i) {
+        if (!atomic_load(&r->slots[r->active[i]].ctx->doomed)) header.client_count++;
+    }
+    snprintf(log_msg, sizeof(log_msg), "서버 교체 요청 (새 PID %d): 상태와 연결 %d개 전달", (int)peer,
+             header.client_count);
     log_event(log_msg);
 
-    // 클라이언트 연결 대기 및 처리 (각 클라이언트는 스레드로 처리하며, 클라이언트가 끊을 때까지 유지)
-    while (1) {
-        client_socket = accept(server_socket, (struct sockaddr *)&client_addr, &client_addr_len);
-        if (client_socket < 0) {
-            perror("연결 수락 실패");
-            continue;
+    int fds[HANDOFF_MAX_FDS];
+    int nfds = 0;
+    for (int i = 0; i < reactor_count; ++i) {
+        fds[nfds++] = reactors[i].listen_fd;
+    }
+    header.listener_count = nfds;
+    if (metrics_exporter_fd() >= 0) {
+        fds[nfds++] = metrics_exporter_fd();
+        header.has_metrics = 1;
+    }
+    int ok = handoff_send(fd, &header, sizeof(header), fds, nfds) == 0;
+    for (int i = 0; ok && i < r->count; ++i) {
+        ClientContext *ctx = r->slots[r->active[i]].ctx;
+        if (atomic_load(&ctx->doomed)) continue;
+        ok = handoff_send_client(fd, ctx) == 0;
+    }
+
+    HandoffControl ready;
+    ok = ok && handoff_recv(fd, &ready, sizeof(ready), NULL, NULL) == (ssize_t)sizeof(ready) &&
+         ready.magic == HANDOFF_MAGIC && ready.step == HANDOFF_READY;
+    if (ok) {
+        // 새 서버가 저널을 열기 전에 마지막 상태를 체크포인트로 남기고 닫음
+        journal_close();
+        HandoffControl commit = { HANDOFF_MAGIC, HANDOFF_VERSION, HANDOFF_COMMIT, 0 };
+        if (handoff_send(fd, &commit, sizeof(commit), NULL, 0) < 0) {
+            JournalState ignored;
+            journal_open(get_journal_path(), &ignored);
+            ok = 0;
         }
+    }
+    close(fd);
+    if (!ok) {
+        log_event_level(LOG_LEVEL_WARN, "서버 교체 중단: 새 서버가 끝까지 응답하지 않아 계속 실행");
+        reactors_resume();
+        return;
+    }
 
-        ClientContext *ctx = malloc(sizeof(ClientContext));
-        if (!ctx) {
-            perror("클라이언트 컨텍스트 할당 실패");
-            close(client_socket);
-            continue;
+    snprintf(log_msg, sizeof(log_msg), "서버 교체 완료: 새 서버(PID %d)가 연결 %d개를 이어받음, 종료",
+             (int)peer, ready.value);
+    log_event(log_msg);
+    // 소켓은 새 서버도 열고 있으므로 shutdown 없이 종료 (종료 시 이 프로세스의 참조만 닫힘)
+    // PID 파일과 교체 소켓 경로는 이미 새 서버 것이므로 지우지 않음
+    actuator_stop();
+    exit(0);
+}
+
+// 연결 하나 이어받기 (새 서버): 레지스트리에만 넣고 리액터 배정과 epoll 등록은 handoff_resume에서
+static int handoff_adopt_client(int fd) {
+    HandoffClient rec;
+    int client_fd = -1;
+    int nfds = 1;
+    if (handoff_recv(fd, &rec, sizeof(rec), &client_fd, &nfds) != (ssize_t)sizeof(rec) || nfds != 1 ||
+        rec.in_len > BUFFER_SIZE || rec.batch_len > BUFFER_SIZE || rec.out_len > HANDOFF_OUT_MAX) {
+        if (nfds == 1) close(client_fd);
+        return -1;
+    }
+
+    size_t total = (size_t)rec.in_len + rec.batch_len + rec.out_len;
+    char *data = malloc(total > 0 ? total : 1);
+    ClientContext *ctx = calloc(1, sizeof(ClientContext));
+    char *batch = rec.batch_active ? malloc(BUFFER_SIZE) : NULL;
+    if (!data || !ctx || (rec.batch_active && !batch) || handoff_recv_data(fd, data, total) < 0) {
+        free(data);
+        free(ctx);
+        free(batch);
+        close(client_fd);
+        return -1;
+    }
+
+    atomic_init(&ctx->refs, 1);  // 레지스트리 참조
+    ctx->socket_fd = client_fd;
+    ctx->addr = rec.addr;
+    pthread_mutex_init(&ctx->out_lock, NULL);
+    atomic_init(&ctx->doomed, 0);
+    atomic_init(&ctx->jobs, 0);
+    atomic_init(&ctx->topics, rec.topics & PROTO_TOPIC_ALL);
+    memcpy(ctx->in.data, data, rec.in_len);
+    ctx->in.len = rec.in_len;
+    ctx->in.discarding = rec.discarding;
+    if (batch) {
+        memcpy(batch, data + rec.in_len, rec.batch_len);
+        ctx->batch = batch;
+        ctx->batch_len = rec.batch_len;
+        ctx->batch_count = rec.batch_count;
+        ctx->batch_overflow = rec.batch_overflow;
+    }
+    ctx->binary = rec.binary;
+    ctx->in.binary = rec.binary;
+
+    int rc = 0;
+    if (rec.out_len > 0) {
+        OutMessage *msg = out_message_new(MSG_RESPONSE, data + rec.in_len + rec.batch_len, rec.out_len);
+        rc = msg ? out_push_locked(ctx, msg) : -1;  // 아직 다른 스레드에 보이지 않으므로 잠금 불필요
+        if (msg) out_message_release(msg);
+    }
+    free(data);
+    if (rc < 0 || client_registry_add(ctx) < 0) {
+        close(client_fd);
+        client_release(ctx);
+        return -1;
+    }
+    return 0;
+}
+
+// --upgrade 시작: 실행 중인 서버에게서 리스닝 소켓, 연결, 상태를 넘겨받음
+// 받은 리스닝 소켓은 listeners에 순서대로 채움 (최대 REACTOR_MAX개)
+// 실패하면 -1 (아직 COMMIT 전이므로 이전 서버가 계속 실행하고, 호출자는 그대로 종료)
+static int handoff_receive(int *listeners, int *listener_count, int *metrics_fd) {
+    char log_msg[2300];
+    int fd = handoff_connect(get_handoff_path());
+    if (fd < 0) {
+        snprintf(log_msg, sizeof(log_msg), "실행 중인 서버의 교체 소켓에 연결할 수 없음 (%s): %s",
+                 get_handoff_path(), strerror(errno));
+        log_event_level(LOG_LEVEL_ERROR, log_msg);
+        return -1;
+    }
+
+    HandoffControl hello = { HANDOFF_MAGIC, HANDOFF_VERSION, HANDOFF_HELLO, 0 };
+    HandoffHeader header;
+    int fds[HANDOFF_MAX_FDS];
+    int nfds = HANDOFF_MAX_FDS;
+    if (handoff_send(fd, &hello, sizeof(hello), NULL, 0) < 0 ||
+        handoff_recv(fd, &header, sizeof(header), fds, &nfds) != (ssize_t)sizeof(header) ||
+        header.magic != HANDOFF_MAGIC || header.version != HANDOFF_VERSION ||
+        header.listener_count < 1 || header.listener_count > REACTOR_MAX ||
+        nfds != header.listener_count + (header.has_metrics ? 1 : 0)) {
+        for (int i = 0; i < nfds; ++i) close(fds[i]);
+        close(fd);
+        log_event_level(LOG_LEVEL_ERROR, "실행 중인 서버가 교체를 거부했거나 버전이 다름");
+        return -1;
+    }
+    if (header.client_count > client_registry.capacity) {
+        for (int i = 0; i < nfds; ++i) close(fds[i]);
+        close(fd);
+        snprintf(log_msg, sizeof(log_msg), "이어받을 연결 %d개가 최대 연결 수(%d)보다 많아 교체 중단",
+                 header.client_count, client_registry.capacity);
+        log_event_level(LOG_LEVEL_ERROR, log_msg);
+        return -1;
+    }
+
+    int adopted = 0;
+    while (adopted < header.client_count && handoff_adopt_client(fd) == 0) {
+        adopted++;
+    }
+    HandoffControl ready = { HANDOFF_MAGIC, HANDOFF_VERSION, HANDOFF_READY, adopted };
+    HandoffControl commit;
+    if (adopted < header.client_count || handoff_send(fd, &ready, sizeof(ready), NULL, 0) < 0 ||
+        handoff_recv(fd, &commit, sizeof(commit), NULL, NULL) != (ssize_t)sizeof(commit) ||
+        commit.magic != HANDOFF_MAGIC || commit.step != HANDOFF_COMMIT) {
+        // 받은 소켓은 종료 시 참조만 닫히므로 이전 서버의 연결에는 영향 없음
+        close(fd);
+        log_event_level(LOG_LEVEL_ERROR, "서버 교체 실패: 상태 수신 중 중단 (이전 서버 계속 실행)");
+        return -1;
+    }
+    close(fd);
+
+    for (int i = 0; i < header.listener_count; ++i) {
+        listeners[i] = fds[i];
+    }
+    *listener_count = header.listener_count;
+    *metrics_fd = header.has_metrics ? fds[header.listener_count] : -1;
+    sensor_filter_configure(&header.filter);
+    handoff_resume_state = header;
+    handoff_adopted = 1;
+
+    snprintf(log_msg, sizeof(log_msg), "서버 교체: 이전 서버에게서 리스닝 소켓 %d개, 연결 %d개와 상태 인수 (LED %d, 7SEG %d)",
+             header.listener_count, adopted, header.led_level, header.segment_digit);
+    log_event(log_msg);
+    return 0;
+}
+
+// 이어받은 연결을 리액터들에 고르게 나눠 epoll에 등록하고 타이머 작업/센서 모니터링 재개
+// (I/O 루프 시작 시, 작업 리액터 스레드를 시작하기 전)
+static void handoff_resume(void) {
+    if (!handoff_adopted) return;
+    handoff_adopted = 0;
+
+    ClientRegistry *r = &client_registry;
+    for (int i = r->count - 1; i >= 0; --i) {
+        ClientContext *ctx = r->slots[r->active[i]].ctx;
+        Reactor *reactor = &reactors[i % reactor_count];
+        reactor_add_client(reactor, ctx);
+        if (io_backend == IO_BACKEND_URING) {
+            continue;  // 수신 등록과 미전송 응답 송신은 리액터가 링을 시작할 때
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = ctx;
+        // 이어받은 미전송 응답은 바로 보내고, 남으면 EPOLLOUT 대기
+        if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, ctx->socket_fd, &ev) < 0 || service_output(ctx) < 0) {
+            close_client(ctx);
+        }
+    }
+
+    HandoffHeader *h = &handoff_resume_state;
+    if (h->countdown_delay_ms >= 0) {
+        segment_countdown_value = h->countdown_value;
+        timer_schedule(&segment_countdown_task, h->countdown_delay_ms);
+    }
+    if (h->quiz_delay_ms >= 0) {
+        quiz_remaining = h->quiz_remaining;
+        quiz_running = timer_schedule(&quiz_task, h->quiz_delay_ms) == 0;
+    }
+    if (h->sensor_monitor) {
+        cds_monitor_start(h->sensor_stable);  // 같은 값이면 LED를 다시 쓰거나 이벤트를 보내지 않음
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // --upgrade: 같은 포트에서 실행 중인 서버의 소켓과 연결을 넘겨받아 교체 (upgrade_server.sh)
+    int upgrade = argc > 1 && strcmp(argv[1], "--upgrade") == 0;
+
+    // 데몬 프로세스로 전환하기 전에 실행 파일 경로를 먼저 얻어야 함
+    // (daemon() 호출 후에는 작업 디렉토리가 "/"로 변경됨)
+    char *exe_dir = get_exe_directory();
+    if (!exe_dir) {
+        // 데몬 전환 전이므로 stderr에 출력
+        fprintf(stderr, "실행 파일 디렉토리를 찾을 수 없습니다.\n");
+        return 1;
+    }
+
+    // 데몬화 실행
+    // nochdir = 0: 작업 디렉토리를 / (루트)로 변경
+    // noclose = 0: 표준 입출력(stdin, stdout, stderr)을 /dev/null로 리다이렉트
+    if (daemon(0, 0) == -1) {
+        perror("daemon failed");
+        return 1;
+    }
+
+    // 이제부터는 데몬 상태입니다.
+    // 비동기 로그 기록 스레드 시작 (fork 이후에 생성해야 스레드가 유지됨)
+    if (logger_start(get_log_file_path()) == 0) {
+        atexit(logger_stop);  // exit() 시 큐에 남은 로그를 모두 기록
+    }
+    // 로그 레벨 (기본 info, warn 이상이면 명령별 수신/응답 로그를 남기지 않음)
+    const char *log_level_env = getenv("DEVICE_SERVER_LOG_LEVEL");
+    if (log_level_env && *log_level_env) {
+        int level = logger_parse_level(log_level_env);
+        if (level >= 0) {
+            logger_set_level((LogLevel)level);
+        } else {
+            log_event_level(LOG_LEVEL_WARN, "DEVICE_SERVER_LOG_LEVEL 값이 올바르지 않아 기본값(info) 사용");
         }
-        ctx->socket_fd = client_socket;
-        ctx->addr = client_addr;
+    }
 
-        pthread_t tid;
-        if (pthread_create(&tid, NULL, client_thread, ctx) != 0) {
-            perror("클라이언트 스레드 생성 실패");
-            close(client_socket);
-            free(ctx);
-            continue;
+    // 서버 교체 중이면 PID 파일은 이전 서버에게서 넘겨받은 뒤에 씀 (실패하면 이전 서버 PID 유지)
+    if (!upgrade) {
+        write_pid_file();
+    }
+    log_event(upgrade ? "서버 데몬 프로세스 시작 (실행 중인 서버 교체)" : "서버 데몬 프로세스 시작");
+
+    // 시그널 핸들러 등록
+    signal(SIGTERM, signal_handler);
+    signal(SIGINT, signal_handler);
+    signal(SIGHUP, signal_handler);  // 장치 라이브러리 재적재 (RELOAD 명령과 같음)
+    signal(SIGPIPE, SIG_IGN);  // 끊어진 소켓에 send 시 프로세스 종료 방지
+
+    // 장치 라이브러리 로딩 (이미 get_exe_directory()가 호출되어 경로가 저장됨)
+    DeviceLibs *libs = calloc(1, sizeof(DeviceLibs));
+    if (!libs || load_symbols(libs) < 0) {
+        log_event_level(LOG_LEVEL_ERROR, "라이브러리 로드 실패로 종료");
+        exit(1);
+    }
+    libs->image_fd = -1;
+    atomic_store(&active_libs, libs);
+
+    // 명령 디스패치 테이블 구성
+    init_command_table();
+    server_metrics.start_ns = metrics_now_ns();
+
+    // 부저 패턴 표 적재 (misc/buzzer_patterns.conf, 없으면 기본 내장 패턴만 사용)
+    char pattern_msg[2200];
+    int pattern_loaded = actuator_load_patterns(get_buzzer_pattern_path());
+    if (pattern_loaded >= 0) {
+        snprintf(pattern_msg, sizeof(pattern_msg), "부저 패턴 %d개 적재: %s", pattern_loaded, get_buzzer_pattern_path());
+        log_event(pattern_msg);
+    }
+
+    // 부저 패턴을 비동기로 재생하는 액추에이터 스레드 시작
+    if (actuator_start(buzzer_tone_write, buzzer_pattern_done) < 0) {
+        log_event_level(LOG_LEVEL_ERROR, "부저 액추에이터 스레드 생성 실패로 종료");
+        exit(1);
+    }
+
+    // CDS 센서 필터 초기 설정 (SENSOR_FILTER 명령과 같은 형식)
+    const char *filter_env = getenv("DEVICE_CDS_FILTER");
+    if (filter_env && *filter_env) {
+        SensorFilterConfig filter_config;
+        sensor_filter_get_config(&filter_config);
+        if (parse_filter_config(filter_env, &filter_config) < 0 || sensor_filter_configure(&filter_config) < 0) {
+            log_event_level(LOG_LEVEL_WARN, "DEVICE_CDS_FILTER 값이 올바르지 않아 기본값 사용");
+        }
+    }
+
+    // 저널에서 마지막 LED/7SEG 상태 복원 (장치 초기화 직후, 클라이언트를 받기 전)
+    // 서버 교체 중이면 이전 서버가 저널을 닫은 뒤에 복원
+    if (!upgrade) {
+        restore_device_state();
+    }
+
+    // 클라이언트 레지스트리 할당 (최대 연결 수만큼 슬롯 미리 확보)
+    int max_clients = MAX_CLIENTS;
+    const char *max_clients_env = getenv("DEVICE_SERVER_MAX_CLIENTS");
+    if (max_clients_env && *max_clients_env) {
+        char *end;
+        long value = strtol(max_clients_env, &end, 10);
+        if (*end == '\0' && value > 0 && value < (1L << CLIENT_SLOT_BITS)) {
+            max_clients = (int)value;
+        } else {
+            log_event_level(LOG_LEVEL_WARN, "DEVICE_SERVER_MAX_CLIENTS 값이 올바르지 않아 기본값 사용");
+        }
+    }
+    if (client_registry_init(max_clients) < 0) {
+        log_event_level(LOG_LEVEL_ERROR, "클라이언트 레지스트리 할당 실패로 종료");
+        exit(1);
+    }
+
+    // CDS 센서 라이브러리 확인 (스레드는 SENSOR_ON 명령으로 시작)
+    if (libs->sensor_init && libs->sensor_get_value) {
+        log_event("CDS 센서 라이브러리 로드됨 (SENSOR_ON 명령으로 모니터링 시작 가능)");
+    } else {
+        log_event_level(LOG_LEVEL_WARN, "경고: CDS 센서 라이브러리가 없어 자동 제어 기능을 사용할 수 없습니다.");
+    }
+    
+    // 리액터 수 (기본 = 온라인 CPU 수)와 리스닝 백로그
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int reactors_wanted = cpus < 1 ? 1 : (cpus > REACTOR_MAX ? REACTOR_MAX : (int)cpus);
+    const char *reactors_env = getenv("DEVICE_SERVER_REACTORS");
+    if (reactors_env && *reactors_env) {
+        char *end;
+        long value = strtol(reactors_env, &end, 10);
+        if (*end == '\0' && value >= 1 && value <= REACTOR_MAX) {
+            reactors_wanted = (int)value;
+        } else {
+            log_event_level(LOG_LEVEL_WARN, "DEVICE_SERVER_REACTORS 값이 올바르지 않아 기본값 사용");
         }
-        pthread_detach(tid); // 스레드 리소스 자동 회수
     }
+    // 연결 I/O 백엔드 (기본 epoll, io_uring은 커널이 필요한 기능을 모두 지원할 때만)
+    const char *io_env = getenv("DEVICE_SERVER_IO");
+    if (io_env && *io_env && strcmp(io_env, "epoll") != 0) {
+        if (strcmp(io_env, "uring") != 0) {
+            log_event_level(LOG_LEVEL_WARN, "DEVICE_SERVER_IO 값이 올바르지 않아 epoll 사용");
+        } else if (!uring_supported()) {
+            log_event_level(LOG_LEVEL_WARN, "커널이 io_uring 다중 수락/수신을 지원하지 않아 epoll 사용");
+        } else {
+            io_backend = IO_BACKEND_URING;
+        }
+    }
+    int backlog = LISTEN_BACKLOG;
+    const char *backlog_env = getenv("DEVICE_SERVER_BACKLOG");
+    if (backlog_env && *backlog_env) {
+        char *end;
+        long value = strtol(backlog_env, &end, 10);
+        if (*end == '\0' && value >= 1 && value <= 65535) {
+            backlog = (int)value;
+        } else {
+            log_event_level(LOG_LEVEL_WARN, "DEVICE_SERVER_BACKLOG 값이 올바르지 않아 기본값 사용");
+        }
+    }
+
+    int listeners[REACTOR_MAX];  // 이전 서버에게서 넘겨받은 리스닝 소켓 (리액터 순서)
+    int listener_count = 0;
+    int metrics_fd = -1;  // 이전 서버에게서 넘겨받은 지표 포트 (없으면 새로 엶)
+    if (upgrade) {
+        // 리스닝 소켓, 연결, 상태를 넘겨받고 이전 서버가 저널을 닫은 뒤 이어서 기록
+        if (handoff_receive(listeners, &listener_count, &metrics_fd) < 0) {
+            log_event_level(LOG_LEVEL_ERROR, "서버 교체 실패로 종료 (이전 서버 계속 실행)");
+            exit(1);
+        }
+        write_pid_file();
+        restore_device_state();
+        journal_origin.source = JOURNAL_SRC_RESTORE;
+        if (handoff_resume_state.led_level >= 0) device_led_set(handoff_resume_state.led_level, 0);
+        if (handoff_resume_state.segment_digit >= 0) device_segment_set(handoff_resume_state.segment_digit);
+        journal_origin.source = JOURNAL_SRC_EVENT;
+    }
+
+    // 리액터마다 리스닝 소켓 하나 (넘겨받은 소켓은 닫으면 그 대기열의 연결이 끊기므로 모두 사용)
+    // 이전 서버보다 리액터를 늘렸으면 같은 포트에 SO_REUSEPORT 소켓을 더 엶
+    if (cmdqueue_init(&command_queue) < 0 ||
+        reactors_init(listener_count > reactors_wanted ? listener_count : reactors_wanted) < 0) {
+        log_event_level(LOG_LEVEL_ERROR, "리액터 할당 실패로 종료");
+        exit(1);
+    }
+    for (int i = 0; i < reactor_count; ++i) {
+        if (i < listener_count) {
+            reactors[i].listen_fd = listeners[i];
+            listen(listeners[i], backlog);  // 백로그 설정만 갱신
+        } else {
+            reactors[i].listen_fd = open_server_socket(backlog);
+        }
+    }
+
+    char log_msg[256];
+    snprintf(log_msg, sizeof(log_msg), "서버가 포트 %d에서 대기 중... (최대 연결 %d개, 리액터 %d개, 백로그 %d, I/O %s)",
+             PORT, max_clients, reactor_count, backlog, io_backend_name());
+    log_event(log_msg);
+
+    // 지표 내보내기 (로컬 포트, 별도 스레드에서 응답하므로 I/O 루프를 막지 않음)
+    int metrics_port = METRICS_PORT;
+    const char *metrics_port_env = getenv("DEVICE_SERVER_METRICS_PORT");
+    if (metrics_port_env && *metrics_port_env) {
+        char *end;
+        long value = strtol(metrics_port_env, &end, 10);
+        if (*end == '\0' && value >= 0 && value <= 65535) {
+            metrics_port = (int)value;
+        } else {
+            log_event_level(LOG_LEVEL_WARN, "DEVICE_SERVER_METRICS_PORT 값이 올바르지 않아 기본값 사용");
+        }
+    }
+    if (metrics_fd >= 0) {
+        if (metrics_exporter_adopt(metrics_fd, render_metrics) < 0) {
+            close(metrics_fd);
+            log_event_level(LOG_LEVEL_WARN, "넘겨받은 지표 포트로 응답 스레드를 시작할 수 없어 STATS 명령으로만 제공");
+        }
+    } else if (metrics_port > 0) {
+        if (metrics_exporter_start(metrics_port, render_metrics) == 0) {
+            snprintf(log_msg, sizeof(log_msg), "지표 내보내기: http://127.0.0.1:%d/metrics", metrics_port);
+            log_event(log_msg);
+        } else {
+            snprintf(log_msg, sizeof(log_msg), "지표 포트 %d를 열 수 없어 STATS 명령으로만 제공", metrics_port);
+            log_event_level(LOG_LEVEL_WARN, log_msg);
+        }
+    }
+
+    // 다음 서버 교체 요청을 받을 소켓 (이전 서버가 쓰던 경로는 넘겨받음)
+    handoff_listen_fd = handoff_listen(get_handoff_path());
+    if (handoff_listen_fd < 0) {
+        char path_msg[2300];  // 교체 소켓 경로가 들어가므로 log_msg보다 크게
+        snprintf(path_msg, sizeof(path_msg), "교체 요청 소켓을 열 수 없어 서버 교체 불가 (%s): %s",
+                 get_handoff_path(), strerror(errno));
+        log_event_level(LOG_LEVEL_WARN, path_msg);
+    }
+
+    // 카운트다운/퀴즈/센서 폴링을 실행하는 타이머 스케줄러 (I/O 루프에서 timerfd로 구동)
+    if (timer_init() < 0) {
+        perror("timerfd 생성 실패");
+        exit(1);
+    }
+
+    // 클라이언트 연결 대기 및 처리 (리액터마다 epoll 루프, 장치 명령은 이 스레드에서 실행)
+    run_event_loop();
 
-    close(server_socket);
     return 0;
 }
 
@@ -0,0 +1,158 @@
+// I/O 루프용 타이머 스케줄러
+// - 마감 시각 기준 최소 힙 (작업은 자기 힙 위치를 기억하므로 취소도 O(log n))
+// - timerfd는 항상 힙 맨 앞 작업의 절대 마감 시각으로 설정 (TFD_TIMER_ABSTIME)
+// - 예약된 작업이 없으면 timerfd를 해제하여 주기적으로 깨어나지 않음
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include "timer.h"
+
+static TimerTask *heap[TIMER_MAX_TASKS];
+static int heap_count = 0;
+static int tfd = -1;
+static uint64_t armed_ns = 0;  // timerfd에 설정된 마감 시각 (0 = 해제됨)
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void heap_set(int index, TimerTask *task)
+{
+    heap[index] = task;
+    task->heap_index = index;
+}
+
+static void sift_up(int index)
+{
+    TimerTask *task = heap[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (heap[parent]->deadline_ns <= task->deadline_ns) break;
+        heap_set(index, heap[parent]);
+        index = parent;
+    }
+    heap_set(index, task);
+}
+
+static void sift_down(int index)
+{
+    TimerTask *task = heap[index];
+    for (;;) {
+        int child = index * 2 + 1;
+        if (child >= heap_count) break;
+        if (child + 1 < heap_count && heap[child + 1]->deadline_ns < heap[child]->deadline_ns) {
+            child++;
+        }
+        if (task->deadline_ns <= heap[child]->deadline_ns) break;
+        heap_set(index, heap[child]);
+        index = child;
+    }
+    heap_set(index, task);
+}
+
+static void heap_remove(TimerTask *task)
+{
+    int index = task->heap_index;
+    task->heap_index = -1;
+    heap_count--;
+    if (index == heap_count) return;
+
+    heap_set(index, heap[heap_count]);
+    if (index > 0 && heap[(index - 1) / 2]->deadline_ns > heap[index]->deadline_ns) {
+        sift_up(index);
+    } else {
+        sift_down(index);
+    }
+}
+
+// 힙 맨 앞 마감 시각으로 timerfd 설정 (바뀐 경우에만 시스템 콜)
+static void rearm_fd(void)
+{
+    uint64_t next = heap_count > 0 ? heap[0]->deadline_ns : 0;
+    if (tfd < 0 || next == armed_ns) return;
+
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    if (next != 0) {
+        its.it_value.tv_sec = (time_t)(next / 1000000000ULL);
+        its.it_value.tv_nsec = (long)(next % 1000000000ULL);
+    }
+    if (timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+        perror("timerfd_settime 실패");
+        return;
+    }
+    armed_ns = next;
+}
+
+static int insert_at(TimerTask *task, uint64_t deadline_ns)
+{
+    if (task->heap_index >= 0) {
+        heap_remove(task);
+    }
+    if (heap_count >= TIMER_MAX_TASKS) {
+        return -1;
+    }
+    if (deadline_ns == 0) deadline_ns = 1;  // 0은 "해제됨" 표시로 사용
+
+    task->deadline_ns = deadline_ns;
+    heap_set(heap_count, task);
+    heap_count++;
+    sift_up(heap_count - 1);
+    rearm_fd();
+    return 0;
+}
+
+int timer_init(void)
+{
+    if (tfd >= 0) return tfd;
+    tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    return tfd;
+}
+
+int timer_fd(void)
+{
+    return tfd;
+}
+
+int timer_schedule(TimerTask *task, long delay_ms)
+{
+    if (delay_ms < 0) delay_ms = 0;
+    return insert_at(task, now_ns() + (uint64_t)delay_ms * 1000000ULL);
+}
+
+int timer_rearm(TimerTask *task, long period_ms)
+{
+    return insert_at(task, task->deadline_ns + (uint64_t)period_ms * 1000000ULL);
+}
+
+void timer_cancel(TimerTask *task)
+{
+    if (task->heap_index < 0) return;
+    heap_remove(task);
+    rearm_fd();
+}
+
+void timer_run_expired(void)
+{
+    uint64_t expirations;
+    if (tfd >= 0 && read(tfd, &expirations, sizeof(expirations)) < 0) {
+        // 논블로킹 timerfd: 이미 비워졌거나 재설정으로 취소된 경우
+    }
+    armed_ns = 0;  // 만료된 일회성 타이머는 자동 해제됨
+
+    uint64_t now = now_ns();
+    // 콜백이 자신(또는 다른 작업)을 다시 예약/취소할 수 있으므로 매번 힙 맨 앞부터 확인
+    while (heap_count > 0 && heap[0]->deadline_ns <= now) {
+        TimerTask *task = heap[0];
+        heap_remove(task);
+        task->fn(task->arg);
+    }
+    rearm_fd();
+}
@@ -0,0 +1,46 @@
+// I/O 루프용 타이머 스케줄러 헤더
+// 카운트다운/퀴즈/센서 폴링 같은 시간 기반 동작을 스레드 대신 취소 가능한 작업으로 실행한다.
+// 마감 시각 최소 힙 하나와 timerfd 하나로 동작하며, 예약된 작업이 없으면 timerfd를 해제하여
+// 유휴 상태에서는 깨어나지 않는다. 모든 함수는 I/O 루프 스레드에서만 호출한다 (잠금 없음).
+
+#ifndef SERVER_TIMER_H
+#define SERVER_TIMER_H
+
+#include <stdint.h>
+
+#define TIMER_MAX_TASKS 16  // 동시에 예약 가능한 작업 수
+
+typedef void (*timer_fn)(void *arg);
+
+// 작업은 호출부가 정적으로 소유하고, 스케줄러는 포인터만 힙에 넣는다
+typedef struct TimerTask {
+    uint64_t deadline_ns;  // CLOCK_MONOTONIC 절대 마감 시각
+    timer_fn fn;
+    void *arg;
+    int heap_index;        // 힙 위치 (-1 = 예약되지 않음)
+} TimerTask;
+
+#define TIMER_TASK_INIT(fn, arg) { 0, (fn), (arg), -1 }
+
+// timerfd 생성 (실패 시 -1), 반환한 fd를 epoll에 등록하고 읽기 가능하면 timer_run_expired 호출
+int timer_init(void);
+int timer_fd(void);
+
+// 지금부터 delay_ms 뒤에 실행 (이미 예약되어 있으면 다시 예약)
+int timer_schedule(TimerTask *task, long delay_ms);
+
+// 직전 마감 시각 + period_ms에 다시 예약 (실행 중인 콜백에서 호출, 주기 오차가 쌓이지 않음)
+int timer_rearm(TimerTask *task, long period_ms);
+
+// 예약 취소 (예약되지 않았으면 아무것도 하지 않음), 취소 즉시 콜백이 다시 호출되지 않음을 보장
+void timer_cancel(TimerTask *task);
+
+static inline int timer_pending(const TimerTask *task)
+{
+    return task->heap_index >= 0;
+}
+
+// 마감된 작업 실행 후 다음 마감 시각으로 timerfd 재설정
+void timer_run_expired(void);
+
+#endif // SERVER_TIMER_H
@@ -0,0 +1,274 @@
+// io_uring 연결 I/O 백엔드 (liburing 없이 io_uring_setup/enter/register 직접 호출)
+// - SQ/CQ는 한 번의 mmap으로 공유하고(IORING_FEAT_SINGLE_MMAP), SQ 배열은 처음에 항등 매핑으로 채워 둠
+// - SINGLE_ISSUER + DEFER_TASKRUN: 완료 처리는 이 링을 만든 스레드가 uring_submit_and_wait로 들어갈 때만 실행되므로,
+//   리액터가 멈춰 있는 동안(서버 교체 등)에는 커널이 소켓에서 데이터를 꺼내 가지 않음
+// - 제공 버퍼 링(IORING_REGISTER_PBUF_RING): 다중 수신이 고른 버퍼는 호출부가 복사 후 바로 돌려줌
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "uring.h"
+
+#define URING_BUF_GROUP 0
+
+static int sys_setup(unsigned entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static void add_buffer(IoRing *ring, unsigned bid)
+{
+    struct io_uring_buf *buf = &ring->buf_ring->bufs[ring->buf_tail & (ring->buf_count - 1)];
+    buf->addr = (uint64_t)(uintptr_t)(ring->bufs + (size_t)bid * ring->buf_size);
+    buf->len = ring->buf_size;
+    buf->bid = (uint16_t)bid;
+    ring->buf_tail++;
+}
+
+static void publish_buffers(IoRing *ring)
+{
+    __atomic_store_n(&ring->buf_ring->tail, ring->buf_tail, __ATOMIC_RELEASE);
+}
+
+int uring_init(IoRing *ring, unsigned buf_count, unsigned buf_size)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+    if (buf_count == 0 || (buf_count & (buf_count - 1)) != 0 || buf_count > 32768) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_SINGLE_ISSUER |
+              IORING_SETUP_DEFER_TASKRUN;
+    p.cq_entries = URING_CQ_ENTRIES;
+    ring->fd = sys_setup(URING_ENTRIES, &p);
+    if (ring->fd < 0) return -1;
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP) || !(p.features & IORING_FEAT_NODROP)) {
+        uring_exit(ring);
+        errno = ENOSYS;
+        return -1;
+    }
+
+    size_t sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    size_t cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    ring->ring_size = sq_size > cq_size ? sq_size : cq_size;
+    ring->ring_ptr = mmap(NULL, ring->ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                          IORING_OFF_SQ_RING);
+    ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                      IORING_OFF_SQES);
+    if (ring->ring_ptr == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        if (ring->ring_ptr == MAP_FAILED) ring->ring_ptr = NULL;
+        if (ring->sqes == MAP_FAILED) ring->sqes = NULL;
+        uring_exit(ring);
+        return -1;
+    }
+
+    char *base = ring->ring_ptr;
+    ring->sq_entries = p.sq_entries;
+    ring->sq_head = (unsigned *)(base + p.sq_off.head);
+    ring->sq_tail = (unsigned *)(base + p.sq_off.tail);
+    ring->sq_mask = *(unsigned *)(base + p.sq_off.ring_mask);
+    unsigned *array = (unsigned *)(base + p.sq_off.array);
+    for (unsigned i = 0; i < p.sq_entries; ++i) {
+        array[i] = i;  // SQE 위치 = 배열 위치 (tail만 올리면 됨)
+    }
+    ring->sq_local_tail = *ring->sq_tail;
+    ring->cq_head = (unsigned *)(base + p.cq_off.head);
+    ring->cq_tail = (unsigned *)(base + p.cq_off.tail);
+    ring->cq_mask = *(unsigned *)(base + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(base + p.cq_off.cqes);
+
+    // 제공 버퍼 링: 링 메모리는 페이지 정렬이어야 하므로 mmap, 버퍼 본체는 한 덩어리로 할당
+    ring->buf_count = buf_count;
+    ring->buf_size = buf_size;
+    ring->buf_ring = mmap(NULL, buf_count * sizeof(struct io_uring_buf), PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ring->bufs = malloc((size_t)buf_count * buf_size);
+    if (ring->buf_ring == MAP_FAILED || !ring->bufs) {
+        if (ring->buf_ring == MAP_FAILED) ring->buf_ring = NULL;
+        uring_exit(ring);
+        errno = ENOMEM;
+        return -1;
+    }
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)ring->buf_ring;
+    reg.ring_entries = buf_count;
+    reg.bgid = URING_BUF_GROUP;
+    if (sys_register(ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        uring_exit(ring);
+        return -1;
+    }
+    for (unsigned bid = 0; bid < buf_count; ++bid) {
+        add_buffer(ring, bid);
+    }
+    publish_buffers(ring);
+    return 0;
+}
+
+void uring_exit(IoRing *ring)
+{
+    if (ring->buf_ring) munmap(ring->buf_ring, ring->buf_count * sizeof(struct io_uring_buf));
+    free(ring->bufs);
+    if (ring->sqes) munmap(ring->sqes, ring->sqes_size);
+    if (ring->ring_ptr) munmap(ring->ring_ptr, ring->ring_size);
+    if (ring->fd >= 0) close(ring->fd);  // 남은 요청은 커널이 취소
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+}
+
+// 채운 SQE를 모두 커널에 넘기고 min_complete개 완료까지 대기
+// (소비되지 않은 SQE는 커널 head 뒤에 남으므로 다음 호출에서 다시 셈)
+static int enter(IoRing *ring, unsigned min_complete)
+{
+    __atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+    unsigned to_submit = ring->sq_local_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (sys_enter(ring->fd, to_submit, min_complete, IORING_ENTER_GETEVENTS) < 0) {
+        // CQ가 넘쳐 커널이 잠시 받지 못함: 호출부가 완료를 꺼낸 뒤 다시 제출
+        return (errno == EBUSY || errno == EAGAIN) ? 0 : -1;
+    }
+    return 0;
+}
+
+static struct io_uring_sqe *get_sqe(IoRing *ring)
+{
+    if (ring->sq_local_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >= ring->sq_entries) {
+        if (enter(ring, 0) < 0 ||
+            ring->sq_local_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >= ring->sq_entries) {
+            return NULL;
+        }
+    }
+    struct io_uring_sqe *sqe = &ring->sqes[ring->sq_local_tail & ring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_local_tail++;
+    return sqe;
+}
+
+int uring_accept_multishot(IoRing *ring, int fd, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = get_sqe(ring);
+    if (!sqe) return -1;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;  // epoll 백엔드 서버로 교체해도 그대로 쓸 수 있도록
+    sqe->user_data = user_data;
+    return 0;
+}
+
+int uring_recv_multishot(IoRing *ring, int fd, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = get_sqe(ring);
+    if (!sqe) return -1;
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUF_GROUP;
+    sqe->user_data = user_data;
+    return 0;
+}
+
+int uring_poll_multishot(IoRing *ring, int fd, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = get_sqe(ring);
+    if (!sqe) return -1;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = user_data;
+    return 0;
+}
+
+int uring_sendmsg(IoRing *ring, int fd, const struct msghdr *msg, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = get_sqe(ring);
+    if (!sqe) return -1;
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)msg;
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = user_data;
+    return 0;
+}
+
+int uring_cancel_all(IoRing *ring, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = get_sqe(ring);
+    if (!sqe) return -1;
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY | IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data = user_data;
+    return 0;
+}
+
+int uring_submit_and_wait(IoRing *ring)
+{
+    return enter(ring, uring_peek(ring) ? 0 : 1);
+}
+
+struct io_uring_cqe *uring_peek(IoRing *ring)
+{
+    unsigned head = *ring->cq_head;  // 이 스레드만 씀
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) return NULL;
+    return &ring->cqes[head & ring->cq_mask];
+}
+
+void uring_advance(IoRing *ring)
+{
+    __atomic_store_n(ring->cq_head, *ring->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+char *uring_buffer(IoRing *ring, unsigned bid)
+{
+    return ring->bufs + (size_t)bid * ring->buf_size;
+}
+
+void uring_recycle(IoRing *ring, unsigned bid)
+{
+    add_buffer(ring, bid);
+    publish_buffers(ring);
+}
+
+int uring_supported(void)
+{
+    IoRing ring;
+    int sv[2];
+    int ok = 0;
+
+    if (uring_init(&ring, 2, 64) < 0) return 0;
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) == 0) {
+        // 데이터를 먼저 넣어 두면 제출과 동시에 완료되므로 대기하지 않음
+        if (write(sv[1], "x", 1) == 1 && uring_recv_multishot(&ring, sv[0], 1) == 0 &&
+            uring_submit_and_wait(&ring) == 0) {
+            struct io_uring_cqe *cqe = uring_peek(&ring);
+            ok = cqe && cqe->res == 1 && (cqe->flags & IORING_CQE_F_BUFFER) && (cqe->flags & IORING_CQE_F_MORE);
+        }
+        close(sv[0]);
+        close(sv[1]);
+    }
+    uring_exit(&ring);
+    return ok;
+}
@@ -0,0 +1,64 @@
+// io_uring 연결 I/O 백엔드 헤더 (liburing 없이 시스템 호출 직접 사용)
+// 리액터 하나가 링 하나를 소유하며, 링을 만든 리액터 스레드만 호출한다 (SINGLE_ISSUER, 잠금 없음).
+// 수락/수신은 한 번 등록하면 계속 완료를 내는 다중(multishot) 요청이고, 수신 데이터는 커널이 제공 버퍼 링에서
+// 고른 버퍼에 담긴다. 송신/재등록 요청은 SQ에 쌓아 두었다가 uring_submit_and_wait 한 번으로 완료 대기와 함께
+// 제출하므로, 연결이 많아도 루프 한 바퀴에 시스템 호출 하나로 처리한다.
+
+#ifndef SERVER_URING_H
+#define SERVER_URING_H
+
+#include <stdint.h>
+#include <sys/socket.h>
+#include <linux/io_uring.h>
+
+#define URING_ENTRIES 256      // SQ 크기 (가득 차면 대기 없이 먼저 제출)
+#define URING_CQ_ENTRIES 4096  // CQ 크기 (다중 요청 완료가 몰려도 넘치지 않도록 SQ보다 크게)
+
+typedef struct IoRing {
+    int fd;
+    unsigned sq_entries;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned sq_mask;
+    unsigned sq_local_tail;     // 채웠지만 아직 커널에 알리지 않은 SQE 포함
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+    void *ring_ptr;             // SQ/CQ 공유 매핑 (IORING_FEAT_SINGLE_MMAP)
+    size_t ring_size;
+    size_t sqes_size;
+    struct io_uring_buf_ring *buf_ring;  // 제공 버퍼 링 (버퍼 그룹 0)
+    unsigned buf_count;
+    unsigned buf_size;
+    uint16_t buf_tail;
+    char *bufs;
+} IoRing;
+
+// 시작 시 확인: 링 생성, 제공 버퍼 링 등록, 소켓 다중 수신을 실제로 시험해 모두 되면 1
+int uring_supported(void);
+
+// 링과 제공 버퍼(buf_count개, 2의 거듭제곱 × buf_size 바이트) 생성, 실패 시 -1 (errno)
+int uring_init(IoRing *ring, unsigned buf_count, unsigned buf_size);
+void uring_exit(IoRing *ring);
+
+// 요청 추가 (제출은 uring_submit_and_wait에서), SQ가 가득 차 먼저 제출하다 실패하면 -1
+int uring_accept_multishot(IoRing *ring, int fd, uint64_t user_data);
+int uring_recv_multishot(IoRing *ring, int fd, uint64_t user_data);
+int uring_poll_multishot(IoRing *ring, int fd, uint64_t user_data);
+int uring_sendmsg(IoRing *ring, int fd, const struct msghdr *msg, uint64_t user_data);
+int uring_cancel_all(IoRing *ring, uint64_t user_data);
+
+// 쌓인 요청을 제출하고, 꺼낼 완료가 없으면 하나 올 때까지 대기 (시그널로 깨면 -1, errno = EINTR)
+int uring_submit_and_wait(IoRing *ring);
+
+// 완료 하나 보기 (없으면 NULL), 다 읽었으면 uring_advance
+struct io_uring_cqe *uring_peek(IoRing *ring);
+void uring_advance(IoRing *ring);
+
+// 수신 완료의 버퍼 (cqe->flags >> IORING_CQE_BUFFER_SHIFT), 다 쓴 버퍼는 링에 돌려줌
+char *uring_buffer(IoRing *ring, unsigned bid);
+void uring_recycle(IoRing *ring, unsigned bid);
+
+#endif // SERVER_URING_H
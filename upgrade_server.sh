@@ -0,0 +1,35 @@
+#!/bin/bash
+# upgrade_server.sh
+
+# 새로 빌드한 서버로 교체 (포트와 클라이언트 연결을 끊지 않음)
+SERVER_EXE="./exec/server"
+PID_FILE="./exec/device_server.pid"
+LOG_FILE="./misc/device_server.log"
+
+echo "=== 장치 제어 서버 교체 ==="
+
+# 1. 실행 중인 서버 확인 (없으면 start_server.sh 사용)
+OLD_PID=$(cat "$PID_FILE" 2>/dev/null)
+if [ -z "$OLD_PID" ] || ! kill -0 "$OLD_PID" 2>/dev/null; then
+    echo "❌ 실행 중인 서버가 없습니다. ./start_server.sh로 시작하세요."
+    exit 1
+fi
+
+# 2. 새 서버 실행: 이전 서버에게서 소켓/연결/상태를 넘겨받음 (sudo 권한, 이전 서버와 같은 사용자)
+echo "새 서버 데몬을 실행합니다... (이전 PID: $OLD_PID)"
+sudo "$SERVER_EXE" --upgrade
+
+# 3. 교체 확인: 이전 서버는 넘겨준 뒤 스스로 종료 (최대 5초 대기)
+for i in {1..5}
+do
+    sleep 1
+    if ! kill -0 "$OLD_PID" 2>/dev/null; then
+        echo "✅ 서버 교체 성공 (PID: $OLD_PID → $(cat "$PID_FILE" 2>/dev/null))"
+        echo "📜 로그 확인: tail -f $LOG_FILE"
+        exit 0
+    fi
+done
+
+echo "❌ 서버 교체 실패! 이전 서버(PID: $OLD_PID)가 계속 실행 중입니다. 로그를 확인하세요."
+tail -n 20 "$LOG_FILE"
+exit 1